@@ -22,6 +22,64 @@
 #define MX25R_SMALL_BLOCK_SIZE  32768   ///< 2 ^ 15, How Large Each half Block is
 #define MX25R_BLOCK_SIZE        65536   ///< 2 ^ 16, How large the Full Block is
 
+// ------------------------------------------- Part Selection ------------------------------------------- //
+
+// Define one of MX25R8035F, MX25R1635F, MX25R3235F or MX25R6435F to fix the geometry at compile time,
+// otherwise the size is given to MX25RInit and bounds checks are done against it at runtime ( only in debug )
+
+#if defined(MX25R8035F)
+#define MX25R_CAPACITY          (1L << 20)  ///< 8 Mbit, How many bytes the part holds
+#define MX25R_DENSITY_ID        0x14        ///< Memory Density reported in the ID
+#elif defined(MX25R1635F)
+#define MX25R_CAPACITY          (1L << 21)  ///< 16 Mbit, How many bytes the part holds
+#define MX25R_DENSITY_ID        0x15        ///< Memory Density reported in the ID
+#elif defined(MX25R3235F)
+#define MX25R_CAPACITY          (1L << 22)  ///< 32 Mbit, How many bytes the part holds
+#define MX25R_DENSITY_ID        0x16        ///< Memory Density reported in the ID
+#elif defined(MX25R6435F)
+#define MX25R_CAPACITY          (1L << 23)  ///< 64 Mbit, How many bytes the part holds
+#define MX25R_DENSITY_ID        0x17        ///< Memory Density reported in the ID
+#endif
+
+#ifdef MX25R_CAPACITY
+
+#define MX25R_PAGE_COUNT        (MX25R_CAPACITY / MX25R_PAGE_SIZE)          ///< How many pages the part has
+#define MX25R_SECTOR_COUNT      (MX25R_CAPACITY / MX25R_SECTOR_SIZE)        ///< How many sectors the part has
+#define MX25R_SMALL_BLOCK_COUNT (MX25R_CAPACITY / MX25R_SMALL_BLOCK_SIZE)   ///< How many half blocks the part has
+#define MX25R_BLOCK_COUNT       (MX25R_CAPACITY / MX25R_BLOCK_SIZE)         ///< How many full blocks the part has
+
+#ifdef __cplusplus
+
+/// @brief Fails to instantiate if a constant address is out of range, C++ won't define a type inside sizeof
+template<bool in_range> struct MX25RStaticCheck {
+
+    static_assert(in_range, "address is out of range for the selected part");
+    enum { value = 0 };
+
+};
+
+/// @brief Checks a constant address against the part at compile time, fails to compile if it is out of range or not a constant
+#define MX25R_STATIC_CHECK(n, count)    ((int)MX25RStaticCheck<((n) >= 0 && (n) < (count))>::value)
+
+#else
+
+/// @brief Checks a constant address against the part at compile time, fails to compile if it is out of range or not a constant
+#define MX25R_STATIC_CHECK(n, count)    (0 * sizeof(struct { _Static_assert((n) >= 0 && (n) < (count), "address is out of range for the selected part"); int in_range; }))
+
+#endif
+
+#define MX25R_STATIC_PAGE(n)            ((MX25RPage)((n) + MX25R_STATIC_CHECK(n, MX25R_PAGE_COUNT)))              ///< A page number known at compile time
+#define MX25R_STATIC_SECTOR(n)          ((MX25RSector)((n) + MX25R_STATIC_CHECK(n, MX25R_SECTOR_COUNT)))          ///< A sector number known at compile time
+#define MX25R_STATIC_SMALL_BLOCK(n)     ((MX25RSmallBlock)((n) + MX25R_STATIC_CHECK(n, MX25R_SMALL_BLOCK_COUNT))) ///< A half block number known at compile time
+#define MX25R_STATIC_BLOCK(n)           ((MX25RBlock)((n) + MX25R_STATIC_CHECK(n, MX25R_BLOCK_COUNT)))            ///< A full block number known at compile time
+
+#endif
+
+typedef uint16_t MX25RSector;       ///< Index of a 4KB sector, every part has at most 2048 and one past the end always fits
+typedef uint16_t MX25RPage;         ///< Index of a 256 byte page, every part has more than 256 and at most 32768
+typedef uint16_t MX25RSmallBlock;   ///< Index of a 32KB block, every part has at most 256 so one past the end needs 16 bits
+typedef uint8_t MX25RBlock;         ///< Index of a 64KB block, every part has at most 128
+
 /// @brief All of the commands that can be run on the flash
 typedef enum MX25RCOMMAND {
 
@@ -128,19 +186,37 @@ typedef struct MX25RHAL {
 
 } MX25RHAL;
 
-/// @brief A struct representing the flash device
+struct MX25RPOWER;
+
+/**
+ * @brief A struct representing the flash device
+ * @note The driver keeps shadows of the registers in here, so every call that may read or change a register takes a non-const device.
+ *       The security register calls, MX25RWriteStatusConfig, programs, erases, the verifies, suspend and resume, burst reads,
+ *       MX25RSetLowPowerMode, MX25RIsOTPRegionLocked and MX25RWriteCommand used to take a const device, callers holding one have to drop the const
+ */
 typedef struct MX25R {
 
     MX25RHAL hal;       ///< Hardware functions to control the Flash
     bool is_write_en;   ///< If we can write to the device
-    #ifdef DEBUG
-    uint8_t size_in_mb; ///< How big the flash is in megabytes, used for bound checking ( only in debug )
+    struct MX25RPOWER* power;   ///< Power governor that wakes the part before each command, NULL if there is none ( see MX25RPower.h )
+    bool is_busy;       ///< If a program, erase or register write may still be running, WIP is only read while this is set
+    uint8_t shadow_known;   ///< Which of the register shadows below hold what the part has
+    uint8_t status;     ///< Shadow of the status register, WIP and WEL are not kept in it
+    uint8_t config[2];  ///< Shadow of the configuration register
+    uint8_t security;   ///< Shadow of the security register, read again after every program or erase
+    uint8_t burst;      ///< Shadow of the last burst wrap setting
+    #if defined(DEBUG) && !defined(MX25R_CAPACITY)
+    uint8_t size_in_mb; ///< How big the flash is in megabytes, used for bound checking ( only in debug without a part selected )
     #endif
 } MX25R;
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // -------------------------------------- Init and Deinit ------------------------------------ //
 
-#ifdef DEBUG
+#if defined(DEBUG) && !defined(MX25R_CAPACITY)
 
 /**
  * @brief Initializes a MX25R Object with the given parameters
@@ -223,7 +299,7 @@ uint8_t MX25RReadConfig(MX25R* const dev, MX25RConfig* const config);
  * @param[out] reg: Where to read the register to
  * @return uint8_t: The Command execution status, 0 if there was an error 
  */
-uint8_t MX25RReadSecurityReg(const MX25R* const dev, MX25RSecurityReg* const reg);
+uint8_t MX25RReadSecurityReg(MX25R* const dev, MX25RSecurityReg* const reg);
 
 /**
  * @brief Read all of the ID 
@@ -243,7 +319,7 @@ uint8_t MX25RReadID(const MX25R* const dev, MX25RID* const id);
  * @param[in] lockdown_otp_sector1: If we want to lock down the first sector of the OTP region
  * @return uint8_t: Command 
  */
-uint8_t MX25RWriteSecurityReg(const MX25R* const dev, bool lockdown_otp_sector1);
+uint8_t MX25RWriteSecurityReg(MX25R* const dev, bool lockdown_otp_sector1);
 
 /**
  * @brief Writes the device status and config registers
@@ -253,7 +329,7 @@ uint8_t MX25RWriteSecurityReg(const MX25R* const dev, bool lockdown_otp_sector1)
  * @param[in] config: Config to write 
  * @return uint8_t: Status, 0 if there was an error
  */
-uint8_t MX25RWriteStatusConfig(const MX25R* const dev, const MX25RStatus* const status, const MX25RConfig* const config);
+uint8_t MX25RWriteStatusConfig(MX25R* const dev, const MX25RStatus* const status, const MX25RConfig* const config);
 
 /**
  * @brief Programs a page (256 bytes) with whatever you feed it
@@ -261,10 +337,10 @@ uint8_t MX25RWriteStatusConfig(const MX25R* const dev, const MX25RStatus* const
  * @param[in] dev: Device to write to
  * @param[in] page: Which page to write to 
  * @param[in] data: Data to Write to the page 
- * @param[in] size: How many bytes to write to the page - 1, 0 is 1 byte written 
+ * @param[in] size: How many bytes to write to the page, 1 to MX25R_PAGE_SIZE 
  * @return uint8_t: How many bytes were registered with the command, 0 if there was an error  
  */
-uint8_t MX25RPageProgram(const MX25R* const dev, const uint16_t page, const uint8_t* const data, const uint8_t size);
+uint8_t MX25RPageProgram(MX25R* const dev, const MX25RPage page, const uint8_t* const data, const uint16_t size);
 
 // ----------------------------------------- Erasing Functions ----------------------------------------------- //
 
@@ -275,7 +351,7 @@ uint8_t MX25RPageProgram(const MX25R* const dev, const uint16_t page, const uint
  * @param[in] sector: Sector to erase 
  * @return uint8_t: How many bytes of the command were processed successfully, 0 if there was an error  
  */
-uint8_t MX25REraseSector(const MX25R* const dev, const uint16_t sector);
+uint8_t MX25REraseSector(MX25R* const dev, const MX25RSector sector);
 
 /**
  * @brief Erases a block of size 32768 so that it can be reprogrammed
@@ -284,7 +360,7 @@ uint8_t MX25REraseSector(const MX25R* const dev, const uint16_t sector);
  * @param[in] block: Block to erase, bounds checking is done if DEBUG is defined 
  * @return uint8_t: Command execution status, 0 if there was an error
  */
-uint8_t MX25REraseBlock32K(const MX25R* const dev, const uint8_t block);
+uint8_t MX25REraseBlock32K(MX25R* const dev, const MX25RSmallBlock block);
 
 /**
  * @brief Erases (Sets the Bits to 1) a block of size 65536 so that it can be reprogrammed
@@ -293,7 +369,7 @@ uint8_t MX25REraseBlock32K(const MX25R* const dev, const uint8_t block);
  * @param[in] block: Block to erase, bounds checking is done in debug mode
  * @return uint8_t: Command Execution status. 0 if there was an error
  */
-uint8_t MX25REraseBlock(const MX25R* const dev, const uint8_t block);
+uint8_t MX25REraseBlock(MX25R* const dev, const MX25RBlock block);
 
 /**
  * @brief Sets all of the bits in the flash to 1, so that it can be reprogrammed
@@ -301,7 +377,7 @@ uint8_t MX25REraseBlock(const MX25R* const dev, const uint8_t block);
  * @param[in] dev: Device to erase 
  * @return uint8_t: Command Execution status, 0 if there was an error 
  */
-uint8_t MX25REraseChip(const MX25R* const dev);
+uint8_t MX25REraseChip(MX25R* const dev);
 
 // ---------------------------------------- OTP Functions --------------------------------------- //
 
@@ -328,7 +404,7 @@ uint8_t MX25RExitOTPRegion(const MX25R* const dev);
  * @return true: If the OTP region is locked and can not be entered 
  * @return false: If the OTP region is available to be entered 
  */
-bool MX25RIsOTPRegionLocked(const MX25R* const dev);
+bool MX25RIsOTPRegionLocked(MX25R* const dev);
 
 // ------------------------------------- Utility Functions ------------------------------------ //
 
@@ -339,7 +415,7 @@ bool MX25RIsOTPRegionLocked(const MX25R* const dev);
  * @return true: If the Erase was successful
  * @return false: If the Erase Failed
  */
-bool MX25RVerifyErase(const MX25R* const dev);
+bool MX25RVerifyErase(MX25R* const dev);
 
 /**
  * @brief Verifies if a Program Performed correctly
@@ -348,7 +424,7 @@ bool MX25RVerifyErase(const MX25R* const dev);
  * @return true: If the program was successful
  * @return false: If the program failed 
  */
-bool MX25RVerifyProgram(const MX25R* const dev);
+bool MX25RVerifyProgram(MX25R* const dev);
 
 /**
  * @brief Resets the device, clears flags and state
@@ -358,6 +434,14 @@ bool MX25RVerifyProgram(const MX25R* const dev);
  */
 uint8_t MX25RReset(MX25R* const dev);
 
+/**
+ * @brief Forgets every shadowed register so the next query reads it from the part, for after the part was changed behind the driver's back
+ * @note A power cycle, a reset done by hand or commands sent through another handle to the same part all need this, @ref MX25RWriteCommand calls it itself
+ * 
+ * @param[in] dev: Device to forget the registers of
+ */
+void MX25RInvalidateShadow(MX25R* const dev);
+
 /**
  * @brief Puts the device into Deep Sleep, super low power option
  * 
@@ -373,7 +457,7 @@ uint8_t MX25RDeepSleep(const MX25R* const dev);
  * @param[in] enabled: If we are gonna use low power mode 
  * @return uint8_t: Status, 0 if there was an error 
  */
-uint8_t MX25RSetLowPowerMode(const MX25R* const dev, const bool enabled);
+uint8_t MX25RSetLowPowerMode(MX25R* const dev, const bool enabled);
 
 /**
  * @brief Pauses any pending programs or erases, check the Security Register to see if you have paused actions after
@@ -381,7 +465,7 @@ uint8_t MX25RSetLowPowerMode(const MX25R* const dev, const bool enabled);
  * @param[in] dev: Device to pause 
  * @return uint8_t: State of the action, 0 indicates error
  */
-uint8_t MX25RSuspend(const MX25R* const dev);
+uint8_t MX25RSuspend(MX25R* const dev);
 
 /**
  * @brief Resumes any oaused erases or programs, check the security register to see if any actions are suspended
@@ -389,7 +473,7 @@ uint8_t MX25RSuspend(const MX25R* const dev);
  * @param[in] dev: Device to Resume actions on 
  * @return uint8_t: Command status, 0 if there was an error 
  */
-uint8_t MX25RResume(const MX25R* const dev);
+uint8_t MX25RResume(MX25R* const dev);
 
 /**
  * @brief Enables high speed burst reading with wrap around of a certain length
@@ -398,7 +482,7 @@ uint8_t MX25RResume(const MX25R* const dev);
  * @param[in] wrap_length: 0 - 3, 0: 8 bytes, 1: 16 bytes, 2: 32 bytes, 3: 64 bytes, else disabled 
  * @return uint8_t: Command Execution status, 0 if there was an error
  */
-uint8_t MX25REnableBurstRead(const MX25R* const dev, const uint8_t wrap_length);
+uint8_t MX25REnableBurstRead(MX25R* const dev, const uint8_t wrap_length);
 
 /**
  * @brief Disables burst reading with wrap around
@@ -406,7 +490,7 @@ uint8_t MX25REnableBurstRead(const MX25R* const dev, const uint8_t wrap_length);
  * @param[in] dev: Device to disable burst reading on
  * @return uint8_t: Command Execution Status, 0 if error
  */
-uint8_t MX25RDisableBurstRead(const MX25R* const dev);
+uint8_t MX25RDisableBurstRead(MX25R* const dev);
 
 // --------------------------------- State Setting and Reading Functions ----------------------------- //
 
@@ -437,6 +521,8 @@ bool MX25RIsWritingEnabled(const MX25R* const dev);
 
 /**
  * @brief Checks if there is a programming in progress
+ * @note The answer comes from driver state, WIP is only read off the bus after this handle started something, was initialized, reset or sent a raw command,
+ *       so call @ref MX25RInvalidateShadow first if anything else may have started work on the part
  * 
  * @param[in] dev: Device to check 
  * @return true: If we are still programming 
@@ -448,6 +534,7 @@ bool MX25RIsWriteInProgress(MX25R* const dev);
 
 /**
  * @brief Writes a command packet to the device, each command takes its own args
+ * @note The register shadows can't follow raw commands, so they are forgotten and the next query reads the part
  * 
  * @param[in] dev: Device to write to 
  * @param[in] cmd: Command to Send 
@@ -455,6 +542,10 @@ bool MX25RIsWriteInProgress(MX25R* const dev);
  * @param[in] args_size: How many arguments are for the comamand 
  * @return uint8_t: The status of the transfer, 0 if there was an error 
  */
-uint8_t MX25RWriteCommand(const MX25R* const dev, const MX25RCommand cmd, const uint8_t* const args, const uint8_t args_size);
+uint8_t MX25RWriteCommand(MX25R* const dev, const MX25RCommand cmd, const uint8_t* const args, const uint8_t args_size);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // include guard
@@ -0,0 +1,114 @@
+/**
+ * @file MX25RCompress.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for the MX25R Compressed Region Layer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_COMPRESS_H
+#define MX25R_COMPRESS_H
+
+#include "MX25R.h"
+
+#ifndef MX25R_COMPRESS_FRAME_SIZE
+#define MX25R_COMPRESS_FRAME_SIZE   1024    ///< How many uncompressed bytes go into each independently decompressible frame, at most 4000 so a stored frame fits in a sector
+#endif
+
+#ifndef MX25R_COMPRESS_HASH_BITS
+#define MX25R_COMPRESS_HASH_BITS    9       ///< 2 ^ value entries in the match finder, each entry is 2 bytes of RAM
+#endif
+
+#define MX25R_COMPRESS_HEADER_SIZE  16      ///< How many bytes the frame header takes at the start of the frame's first page
+#define MX25R_COMPRESS_NO_FRAME     0xffff  ///< Index value for a frame that has never been written
+
+/// @brief Worst case size of a stored frame, data that does not compress is stored as is
+#define MX25R_COMPRESS_MAX_STORED   (MX25R_COMPRESS_FRAME_SIZE + MX25R_COMPRESS_FRAME_SIZE / 255 + 16)
+
+#if MX25R_COMPRESS_HEADER_SIZE + MX25R_COMPRESS_MAX_STORED > MX25R_SECTOR_SIZE
+#error "MX25R_COMPRESS_FRAME_SIZE is too big, frames never straddle sectors so a stored frame has to fit in one"
+#endif
+
+/**
+ * @brief A region of flash holding LZ4 style compressed frames, each frame starts on a page boundary and decompresses on its own
+ * @note The sectors are used as a ring, frames are appended at the head and the oldest sector is reclaimed by moving its live frames to the head,
+ *       one sector is always kept erased so that move never runs out of room
+ */
+typedef struct MX25RCOMPRESSREGION {
+
+    MX25R* dev;                     ///< Device the region is on
+    uint16_t first_sector;          ///< First sector of the region
+    uint16_t sector_count;          ///< How many sectors are in the region
+    uint16_t* index;                ///< For each frame, the page in the region it was last written to, MX25R_COMPRESS_NO_FRAME if never written
+    uint16_t frame_count;           ///< How many frames the index has room for
+    uint32_t write_page;            ///< The next free page in the region to append to, always in the head sector
+    uint32_t sequence;              ///< Sequence number the next stored frame gets, it orders the copies of a frame
+    uint16_t head;                  ///< Sector of the region frames are appended to
+    uint16_t tail;                  ///< Oldest sector of the region that can still hold live frames, the next to be reclaimed
+    uint16_t cached_frame;          ///< Which frame is currently decompressed in raw, MX25R_COMPRESS_NO_FRAME if none
+    uint16_t cached_size;           ///< How many bytes of raw are valid for the cached frame
+
+    uint16_t hash[1 << MX25R_COMPRESS_HASH_BITS];               ///< Match finder table for the compressor
+    uint8_t raw[MX25R_COMPRESS_FRAME_SIZE];                     ///< Uncompressed frame buffer
+    uint8_t packed[MX25R_COMPRESS_HEADER_SIZE + MX25R_COMPRESS_MAX_STORED]; ///< Header and stored frame buffer, laid out exactly as on flash
+
+} MX25RCompressRegion;
+
+/**
+ * @brief Mounts a compressed region, scanning the frame headers to rebuild the frame index
+ * @note Only the headers are read, once to find the newest frame and once more to replay the ring from its oldest sector, then the free pages of the head sector are blank checked
+ * @param[out] region: Region to mount
+ * @param[in] dev: Device the region is on
+ * @param[in] first_sector: First sector of the region
+ * @param[in] sector_count: How many sectors are in the region, at least 3
+ * @param[in] index: Storage for the frame index, one entry per frame
+ * @param[in] frame_count: How many frames the region holds, the logical size is frame_count * MX25R_COMPRESS_FRAME_SIZE
+ * @return MX25RCompressRegion*: NULL if it failed to mount and region if it worked
+ */
+MX25RCompressRegion* MX25RCompressMount(MX25RCompressRegion* const region, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, uint16_t* const index, const uint16_t frame_count);
+
+/**
+ * @brief Erases the whole region and forgets every frame
+ *
+ * @param[in] region: Region to erase
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RCompressFormat(MX25RCompressRegion* const region);
+
+/**
+ * @brief Compresses and appends a frame, replacing any older copy of it
+ * @note When the head sector is full and only the spare sector is left, the oldest sector is reclaimed first, which programs its live frames again and erases it
+ *
+ * @param[in] region: Region to write to
+ * @param[in] frame: Which frame to write, the frame covers logical bytes frame * MX25R_COMPRESS_FRAME_SIZE and up
+ * @param[in] data: Uncompressed frame contents
+ * @param[in] size: How many bytes are in the frame, 1 to MX25R_COMPRESS_FRAME_SIZE, the rest of the frame reads as 0xff
+ * @return uint8_t: Status, 0 if there was an error or the live frames fill the region
+ */
+uint8_t MX25RCompressWriteFrame(MX25RCompressRegion* const region, const uint16_t frame, const uint8_t* const data, const uint16_t size);
+
+/**
+ * @brief Reads uncompressed bytes from anywhere in the region, only the frames that are touched get read and decompressed
+ *
+ * @param[in] region: Region to read from
+ * @param[in] address: Logical address to start reading from
+ * @param[out] output: Buffer to read into
+ * @param[in] size: How many bytes to read
+ * @return uint8_t: Status, 0 if there was an error or a frame was corrupt
+ */
+uint8_t MX25RCompressRead(MX25RCompressRegion* const region, const uint32_t address, uint8_t* const output, const uint32_t size);
+
+/**
+ * @brief Gets how many pages can be appended before the oldest sector has to be reclaimed
+ *
+ * @param[in] region: Region to check
+ * @return uint32_t: The number of free pages
+ */
+uint32_t MX25RCompressFreePages(const MX25RCompressRegion* const region);
+
+#endif // include guard
@@ -0,0 +1,31 @@
+/**
+ * @file MX25RCrc.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Declarations for the Checksums used to validate data stored on the MX25R
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_CRC_H
+#define MX25R_CRC_H
+
+#include <stdint.h>
+
+#define MX25R_CRC16_INIT        0xffff  ///< What to seed a fresh CRC16 with
+
+/**
+ * @brief Runs a CRC16 (CCITT polynomial 0x1021) over a buffer, can be chained over several buffers by feeding the last result back in
+ *
+ * @param[in] crc: The CRC so far, MX25R_CRC16_INIT to start a new one
+ * @param[in] data: Data to run the CRC over
+ * @param[in] size: How many bytes are in data
+ * @return uint16_t: The updated CRC
+ */
+uint16_t MX25RCrc16(uint16_t crc, const void* const data, const uint32_t size);
+
+#endif // include guard
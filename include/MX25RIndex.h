@@ -0,0 +1,137 @@
+/**
+ * @file MX25RIndex.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for the MX25R Record Log with a Per-Sector Key Summary Index
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_INDEX_H
+#define MX25R_INDEX_H
+
+#include "MX25R.h"
+
+#ifndef MX25R_INDEX_MAX_SECTORS
+#define MX25R_INDEX_MAX_SECTORS     128         ///< The most data sectors a log can have, each takes a summary in RAM, at most 254
+#endif
+
+#ifndef MX25R_INDEX_SCAN_SIZE
+#define MX25R_INDEX_SCAN_SIZE       1024        ///< How many bytes of records a query reads at a time, a multiple of the page size
+#endif
+
+#define MX25R_INDEX_TABLE_SECTORS   2           ///< Sectors at the start of the region holding the summary table, one is written while the other is compacted into
+#define MX25R_INDEX_EMPTY_KEY       0xffffffff  ///< Key of an erased record slot, records can't use it
+
+/// @brief What a summary entry says about its sector
+typedef enum MX25RINDEXKIND {
+
+    MX25R_INDEX_SEALED,     ///< The sector is full and its keys are between min_key and max_key
+    MX25R_INDEX_OPENING,    ///< The sector is about to be erased for reuse, what it holds is stale
+    MX25R_INDEX_OPEN,       ///< The sector is erased and records are being appended to it
+    MX25R_INDEX_TABLE,      ///< Not about a sector, marks a table sector as holding the whole state
+
+} MX25RIndexKind;
+
+/// @brief RAM copy of the newest summary table entry for a data sector
+typedef struct MX25RINDEXSUMMARY {
+
+    uint32_t sequence;      ///< Sequence number of the entry, 0 if the sector has none
+    uint32_t min_key;       ///< Smallest key in the sector, only valid once sealed
+    uint32_t max_key;       ///< Largest key in the sector, only valid once sealed
+    uint8_t kind;           ///< MX25RIndexKind of the entry
+
+} MX25RIndexSummary;
+
+/**
+ * @brief A circular log of fixed size records, each starting with a 4 byte key in native byte order, indexed by the key range of each sector
+ * @note A query only reads the sectors whose key range overlaps what it asks for, so its cost follows the size of the result,
+ *       each record is followed on flash by a CRC16 of it so one torn by a power loss is never returned
+ */
+typedef struct MX25RINDEX {
+
+    MX25R* dev;                                     ///< Device the log is on
+    uint16_t first_sector;                          ///< First sector of the region, the summary table comes first and then the data sectors
+    uint16_t data_count;                            ///< How many data sectors there are
+    uint16_t record_size;                           ///< Size of every record
+    uint16_t slot_size;                             ///< Size of a record on flash, the record and the CRC16 of it after
+    uint16_t records_per_sector;                    ///< How many records fit in a sector, records never straddle sectors
+
+    uint32_t sequence;                              ///< Sequence number of the newest summary table entry
+    uint8_t table;                                  ///< Table sector new entries go to
+    uint16_t table_next;                            ///< Next free entry in that table sector
+
+    uint16_t open_sector;                           ///< Data sector records are appended to
+    uint16_t open_count;                            ///< How many records the open sector holds
+    uint32_t open_min;                              ///< Smallest key in the open sector
+    uint32_t open_max;                              ///< Largest key in the open sector
+    uint32_t written;                               ///< How many bytes of the open sector are programmed
+    uint16_t page_fill;                             ///< How many bytes of the staging page are filled, the ones already programmed are 0xff
+    uint8_t page[MX25R_PAGE_SIZE];                  ///< Staging page for the end of the open sector
+
+    MX25RIndexSummary summary[MX25R_INDEX_MAX_SECTORS]; ///< Newest summary of every data sector
+    uint8_t scan[MX25R_INDEX_SCAN_SIZE];            ///< Scratch for queries, mounting and table entries
+
+} MX25RIndex;
+
+/**
+ * @brief Mounts a log, loading the summary table into RAM and finding where appending left off
+ * @note A region that was never formatted fails to mount, call @ref MX25RIndexFormat on it instead
+ *
+ * @param[out] index: Log to mount
+ * @param[in] dev: Device the log is on
+ * @param[in] first_sector: First sector of the region
+ * @param[in] sector_count: How many sectors the region has, the table sectors and at least two data sectors
+ * @param[in] record_size: Size of every record, at least 4 bytes for the key and at most MX25R_INDEX_SCAN_SIZE - 2
+ * @return MX25RIndex*: NULL if it failed to mount and index if it worked
+ */
+MX25RIndex* MX25RIndexMount(MX25RIndex* const index, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint16_t record_size);
+
+/**
+ * @brief Sets up an empty log on a region, only the table and the first data sector are erased, the rest are erased as the log reaches them
+ * @note Needs nothing from a mount, so it works on a region that never held a log
+ *
+ * @param[out] index: Log to format
+ * @param[in] dev: Device the log is on
+ * @param[in] first_sector: First sector of the region
+ * @param[in] sector_count: How many sectors the region has, the table sectors and at least two data sectors
+ * @param[in] record_size: Size of every record, at least 4 bytes for the key and at most MX25R_INDEX_SCAN_SIZE - 2
+ * @return uint8_t: Status, 0 if the region is not valid or there was an error
+ */
+uint8_t MX25RIndexFormat(MX25RIndex* const index, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint16_t record_size);
+
+/**
+ * @brief Appends a record, once the log is full the oldest sector of records is dropped to make room
+ * @note Records are programmed a page at a time, call @ref MX25RIndexSync to make the newest ones survive a power loss
+ *
+ * @param[in] index: Log to append to
+ * @param[in] record: Record to append, record_size bytes starting with its key
+ * @return uint8_t: Status, 0 if the key is MX25R_INDEX_EMPTY_KEY or there was an error
+ */
+uint8_t MX25RIndexAppend(MX25RIndex* const index, const void* const record);
+
+/**
+ * @brief Programs any records still waiting in the staging page
+ *
+ * @param[in] index: Log to sync
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RIndexSync(MX25RIndex* const index);
+
+/**
+ * @brief Finds every record with a key from min_key to max_key, oldest sector first
+ *
+ * @param[in] index: Log to search
+ * @param[in] min_key: Smallest key to find
+ * @param[in] max_key: Largest key to find
+ * @param[in] found: Called with each record found, return false to stop the query
+ * @param[in] context: Passed to found
+ * @return uint32_t: How many records were found
+ */
+uint32_t MX25RIndexQuery(MX25RIndex* const index, const uint32_t min_key, const uint32_t max_key, bool (*found)(void* const context, const uint8_t* const record), void* const context);
+
+#endif // include guard
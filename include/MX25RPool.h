@@ -0,0 +1,109 @@
+/**
+ * @file MX25RPool.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for the MX25R Pre-Erased Sector Pool
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_POOL_H
+#define MX25R_POOL_H
+
+#include "MX25R.h"
+
+#ifndef MX25R_POOL_CAPACITY
+#define MX25R_POOL_CAPACITY     8       ///< The Most Erased Sectors that a pool can keep ready at once
+#endif
+
+#ifndef MX25R_POOL_BACKLOG
+#define MX25R_POOL_BACKLOG      32      ///< The Most Released Sectors that can be waiting to be erased at once
+#endif
+
+/// @brief A pool of sectors that are erased in the background so that allocating one never waits on an erase
+typedef struct MX25RPOOL {
+
+    MX25R* dev;                             ///< Device the sectors live on
+    const uint8_t* erased_map;              ///< Persisted bitmap of which sectors in the region are erased, NULL to blank check the flash instead
+    uint16_t first_sector;                  ///< First sector of the region managed by the pool
+    uint16_t sector_count;                  ///< How many sectors are in the managed region
+    uint16_t scan_cursor;                   ///< Next sector in the region to look at for being already erased
+    uint8_t target;                         ///< How many erased sectors we try to keep ready
+
+    uint16_t ready[MX25R_POOL_CAPACITY];    ///< Ring of erased sectors ready to be handed out
+    uint8_t ready_head;                     ///< Index of the next ready sector to hand out
+    uint8_t ready_count;                    ///< How many sectors are ready
+
+    uint16_t backlog[MX25R_POOL_BACKLOG];   ///< Ring of released sectors that still need to be erased
+    uint8_t backlog_head;                   ///< Index of the next sector to erase
+    uint8_t backlog_count;                  ///< How many sectors are waiting to be erased
+
+    uint16_t ahead[MX25R_POOL_BACKLOG];     ///< Released sectors the scan has not reached yet, the release already accounts for them so the scan skips them
+    uint8_t ahead_count;                    ///< How many released sectors are still ahead of the scan
+
+    uint16_t erasing;                       ///< Sector currently being erased, only valid if is_erasing
+    bool is_erasing;                        ///< If there is a background erase running
+    bool is_suspended;                      ///< If the background erase was suspended so the caller can use the flash
+
+} MX25RPool;
+
+/**
+ * @brief Initializes a pool over a region of sectors, the region is considered owned by the pool, any blank sector in it is free to hand out
+ *
+ * @param[out] pool: Pool to Initialize
+ * @param[in] dev: Device the region is on
+ * @param[in] first_sector: First sector of the region
+ * @param[in] sector_count: How many sectors are in the region
+ * @param[in] target: How many erased sectors to keep ready, at most MX25R_POOL_CAPACITY
+ * @param[in] erased_map: Persisted bitmap with a bit set for each sector in the region that is erased, NULL to blank check each sector instead
+ * @return MX25RPool*: NULL if it failed to initialize and pool if it worked
+ */
+MX25RPool* MX25RPoolInit(MX25RPool* const pool, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint8_t target, const uint8_t* const erased_map);
+
+/**
+ * @brief Hands out an erased sector, never touches the flash
+ *
+ * @param[in] pool: Pool to take the sector from
+ * @param[out] sector: Where to put the sector number
+ * @return uint8_t: Status, 0 if there were no erased sectors ready
+ */
+uint8_t MX25RPoolAllocate(MX25RPool* const pool, uint16_t* const sector);
+
+/**
+ * @brief Gives a sector back to the pool, it will be erased in the background by @ref MX25RPoolService
+ *
+ * @param[in] pool: Pool to give the sector to
+ * @param[in] sector: Sector that is no longer used
+ * @return uint8_t: Status, 0 if the sector is not in the region, the backlog is full or too many released sectors are still ahead of the scan
+ */
+uint8_t MX25RPoolRelease(MX25RPool* const pool, const uint16_t sector);
+
+/**
+ * @brief Does one step of refilling the pool without blocking, call it whenever the flash is idle
+ * @note Starts at most one erase or one blank check per call, a running erase is only polled
+ * @param[in] pool: Pool to refill
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RPoolService(MX25RPool* const pool);
+
+/**
+ * @brief Suspends any background erase so that the caller can program or read the flash right away, @ref MX25RPoolService resumes it
+ *
+ * @param[in] pool: Pool to pause the erasing of
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RPoolYield(MX25RPool* const pool);
+
+/**
+ * @brief Gets how many erased sectors are ready to be handed out
+ *
+ * @param[in] pool: Pool to check
+ * @return uint8_t: The number of sectors ready
+ */
+uint8_t MX25RPoolReadyCount(const MX25RPool* const pool);
+
+#endif // include guard
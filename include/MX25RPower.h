@@ -0,0 +1,129 @@
+/**
+ * @file MX25RPower.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for the MX25R Power Governor
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_POWER_H
+#define MX25R_POWER_H
+
+#include "MX25R.h"
+
+#ifndef MX25R_POWER_WAKE_US
+#define MX25R_POWER_WAKE_US         35      ///< tRDP, how long the part takes to come out of deep sleep after a CS pulse
+#endif
+
+#ifndef MX25R_POWER_MIN_IDLE_US
+#define MX25R_POWER_MIN_IDLE_US     1000    ///< Shortest idle timeout, below this the wake costs more than the sleep saves
+#endif
+
+#ifndef MX25R_POWER_MAX_IDLE_US
+#define MX25R_POWER_MAX_IDLE_US     100000  ///< Longest idle timeout, also caps the gaps that go into the average
+#endif
+
+#ifndef MX25R_POWER_IDLE_FACTOR
+#define MX25R_POWER_IDLE_FACTOR     4       ///< How many average gaps without an access count as idle
+#endif
+
+#ifndef MX25R_POWER_AVERAGE_SHIFT
+#define MX25R_POWER_AVERAGE_SHIFT   3       ///< Weight of each new gap in the average is 1 / 2 ^ this
+#endif
+
+#ifndef MX25R_POWER_BURST_PENDING
+#define MX25R_POWER_BURST_PENDING   4       ///< How many queued operations switch the part to high performance mode
+#endif
+
+/// @brief Puts the part to sleep when it goes idle, wakes it on the next command and picks its power mode from the queued work
+typedef struct MX25RPOWER {
+
+    MX25R* dev;                             ///< Device being governed
+    uint32_t (*now_us)(void);               ///< Free running microsecond clock, allowed to wrap
+    void (*delay_us)(const uint32_t us);    ///< Busy waits for some microseconds, NULL if the HAL is too slow to need the wake delay
+
+    uint32_t last_access_us;                ///< When the last command was sent
+    uint32_t average_gap_us;                ///< Moving average of the time between commands
+    uint32_t pending;                       ///< How many operations the caller has queued and not finished
+
+    bool is_asleep;                         ///< If the part is in deep sleep
+    bool is_high_performance;               ///< If the part is in high performance mode
+    bool is_mode_changing;                  ///< If a write of the configuration register may still be running
+    bool is_restoring_write_en;             ///< If the caller had write enable before a mode change cleared it, it is sent again before the next program, erase or register write
+    bool is_governing;                      ///< If the commands on the bus are the governor's own
+
+} MX25RPower;
+
+/**
+ * @brief Attaches a governor to a device, from then on every command wakes the part if it needs it
+ * @note The part is assumed to be awake and in its power on default, ultra low power mode
+ *
+ * @param[out] power: Governor to Initialize
+ * @param[in] dev: Device to govern
+ * @param[in] now_us: Free running microsecond clock
+ * @param[in] delay_us: Microsecond busy wait used for the wake delay, NULL to skip it
+ * @return MX25RPower*: NULL if it failed to initialize and power if it worked
+ */
+MX25RPower* MX25RPowerInit(MX25RPower* const power, MX25R* const dev, uint32_t (*now_us)(void), void (*delay_us)(const uint32_t us));
+
+/**
+ * @brief Wakes the part up and detaches the governor from the device
+ *
+ * @param[in] power: Governor to Deinit
+ */
+void MX25RPowerDeinit(MX25RPower* const power);
+
+/**
+ * @brief Lets the governor know more work is coming, enough of it switches the part to high performance mode before it starts
+ *
+ * @param[in] power: Governor to tell
+ * @param[in] count: How many operations were queued
+ * @return uint8_t: Status, 0 if there was an error switching modes
+ */
+uint8_t MX25RPowerQueue(MX25RPower* const power, const uint32_t count);
+
+/**
+ * @brief Lets the governor know queued work is done
+ *
+ * @param[in] power: Governor to tell
+ * @param[in] count: How many operations finished
+ */
+void MX25RPowerComplete(MX25RPower* const power, const uint32_t count);
+
+/**
+ * @brief Does the background work, drops to ultra low power and then deep sleep as the part stays idle, never blocks
+ *
+ * @param[in] power: Governor to service
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RPowerService(MX25RPower* const power);
+
+/**
+ * @brief Gets how long the part has to go without a command before it is put to sleep, learned from recent commands
+ *
+ * @param[in] power: Governor to check
+ * @return uint32_t: The idle timeout in microseconds
+ */
+uint32_t MX25RPowerIdleTimeout(const MX25RPower* const power);
+
+/**
+ * @brief Called by the driver before a program, erase or register write, sends write enable again if a mode change cleared the caller's
+ *
+ * @param[in] power: Governor attached to the device
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RPowerRestoreWriting(MX25RPower* const power);
+
+/**
+ * @brief Called by the driver before every command, wakes the part and keeps track of how often it is used
+ *
+ * @param[in] power: Governor attached to the device
+ */
+void MX25RPowerOnCommand(MX25RPower* const power);
+
+#endif // include guard
@@ -0,0 +1,107 @@
+/**
+ * @file MX25RTransaction.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for Atomic Multi-Page Transactions on the MX25R
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_TRANSACTION_H
+#define MX25R_TRANSACTION_H
+
+#include "MX25R.h"
+
+#ifndef MX25R_TRANSACTION_JOURNAL_SECTORS
+#define MX25R_TRANSACTION_JOURNAL_SECTORS   2       ///< How many sectors at the start of a region hold commit records, at least 2
+#endif
+
+#define MX25R_TRANSACTION_MAX_PAGES         120     ///< The most logical pages a region can have, the whole page map has to fit in one commit record page
+#define MX25R_TRANSACTION_NO_PAGE           0xffff  ///< Map entry for a logical page that has never been written, it reads as erased
+
+/**
+ * @brief A region of flash whose logical pages are only ever updated all together or not at all
+ * @note Writes go to fresh shadow pages and a commit is a single page holding the whole logical to physical page map,
+ *       so the newest valid commit record in the journal is the state of the region, power loss at any point can't tear it
+ */
+typedef struct MX25RTRANSACTIONREGION {
+
+    MX25R* dev;                                     ///< Device the region is on
+    uint16_t first_sector;                          ///< First sector of the region, the journal comes first and then the data sectors
+    uint16_t data_sector_count;                     ///< How many sectors after the journal hold shadow pages
+    uint16_t page_count;                            ///< How many logical pages the region holds
+    uint32_t sequence;                              ///< Sequence number of the newest commit record
+    uint16_t journal_page;                          ///< Page in the journal that the next commit record goes to
+    uint16_t open_sector;                           ///< Data sector that new shadow pages are taken from, MX25R_TRANSACTION_NO_PAGE if none
+    uint8_t open_next;                              ///< Next unused page of the open sector
+    bool in_transaction;                            ///< If a transaction has begun and not been committed or aborted
+    bool is_dirty;                                  ///< If the running transaction has staged any writes
+
+    uint16_t map[MX25R_TRANSACTION_MAX_PAGES];      ///< Committed map from logical page to physical data page
+    uint16_t staged[MX25R_TRANSACTION_MAX_PAGES];   ///< Map including the staged writes, equal to map outside a transaction
+    uint8_t page[MX25R_PAGE_SIZE];                  ///< Scratch page for commit records and relocating pages
+
+} MX25RTransactionRegion;
+
+/**
+ * @brief Mounts a transactional region, recovering the last committed state
+ * @note Recovery reads each journal page once, so it takes the same bounded time no matter how the region was left
+ * @param[out] region: Region to mount
+ * @param[in] dev: Device the region is on
+ * @param[in] first_sector: First sector of the region
+ * @param[in] sector_count: How many sectors the region has, including the journal, the data sectors need room for at least twice page_count plus two sectors to run well
+ * @param[in] page_count: How many logical pages the region holds, at most MX25R_TRANSACTION_MAX_PAGES
+ * @return MX25RTransactionRegion*: NULL if it failed to mount and region if it worked
+ */
+MX25RTransactionRegion* MX25RTransactionMount(MX25RTransactionRegion* const region, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint16_t page_count);
+
+/**
+ * @brief Begins a transaction, reclaiming space from old shadow pages first if it is running low
+ *
+ * @param[in] region: Region to begin a transaction on
+ * @return uint8_t: Status, 0 if there was an error or a transaction is already running
+ */
+uint8_t MX25RTransactionBegin(MX25RTransactionRegion* const region);
+
+/**
+ * @brief Stages a write of a whole logical page, nothing is visible after a power loss until @ref MX25RTransactionCommit
+ *
+ * @param[in] region: Region to write to
+ * @param[in] page: Logical page to replace
+ * @param[in] data: New contents of the page
+ * @param[in] size: How many bytes of data there are, 1 to MX25R_PAGE_SIZE, the rest of the page reads as 0xff
+ * @return uint8_t: Status, 0 if there was an error or the region ran out of shadow pages
+ */
+uint8_t MX25RTransactionWrite(MX25RTransactionRegion* const region, const uint16_t page, const uint8_t* const data, const uint16_t size);
+
+/**
+ * @brief Atomically makes every staged write visible, costs a single page program
+ *
+ * @param[in] region: Region to commit
+ * @return uint8_t: Status, 0 if there was an error, in which case the last commit is still the state of the region
+ */
+uint8_t MX25RTransactionCommit(MX25RTransactionRegion* const region);
+
+/**
+ * @brief Throws away every staged write
+ *
+ * @param[in] region: Region to abort the transaction on
+ */
+void MX25RTransactionAbort(MX25RTransactionRegion* const region);
+
+/**
+ * @brief Reads logical bytes from the region, inside a transaction this includes the staged writes
+ *
+ * @param[in] region: Region to read from
+ * @param[in] address: Logical address to read from
+ * @param[out] output: Buffer to read into
+ * @param[in] size: How many bytes to read
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RTransactionRead(MX25RTransactionRegion* const region, const uint32_t address, uint8_t* const output, const uint32_t size);
+
+#endif // include guard
@@ -0,0 +1,125 @@
+/**
+ * @file MX25RUpdate.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for the MX25R Delta Firmware Update Writer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_UPDATE_H
+#define MX25R_UPDATE_H
+
+#include "MX25R.h"
+
+#define MX25R_UPDATE_MAGIC          0x5544  ///< Marks a valid checkpoint
+#define MX25R_UPDATE_HEADER_SIZE    9       ///< Longest op header, a copy is the op byte, a length and a source offset
+
+/**
+ * @brief The ops a delta is made of, each one is an op byte followed by little endian fields
+ * @note A delta is just these ops back to back, applied in order they write the new image from the start of the target slot
+ */
+typedef enum MX25RUPDATEOP {
+
+    MX25R_UPDATE_COPY       = 0x01, ///< u32 length, u32 source offset: copies length bytes from that offset in the current slot
+    MX25R_UPDATE_INSERT     = 0x02, ///< u32 length, then length bytes: writes those bytes as they are
+
+} MX25RUpdateOp;
+
+/// @brief Where a delta was applied up to, persist it somewhere safe to pick up an interrupted update with @ref MX25RUpdateResume
+typedef struct MX25RUPDATECHECKPOINT {
+
+    uint16_t magic;                                 ///< MX25R_UPDATE_MAGIC
+    uint16_t crc;                                   ///< CRC16 over everything after it
+    uint32_t delta_offset;                          ///< How many bytes of the delta were taken in, send the rest starting here
+    uint32_t written;                               ///< How many bytes of the new image are programmed
+    uint32_t op_remaining;                          ///< Bytes left in the op that was running
+    uint32_t op_source;                             ///< Where the running copy reads from next
+    uint16_t erased_blocks;                         ///< How many blocks of the target slot are erased and verified
+    uint8_t op;                                     ///< The running op, 0 if between ops
+    uint8_t header_size;                            ///< How much of the next op header was taken in
+    uint8_t header[MX25R_UPDATE_HEADER_SIZE];       ///< The part of the next op header that was taken in
+
+} MX25RUpdateCheckpoint;
+
+/// @brief Applies a delta against the current slot into the target slot, erasing the next block while the current one is programmed
+typedef struct MX25RUPDATE {
+
+    MX25R* dev;                                     ///< Device both slots are on
+    uint32_t source;                                ///< Address of the current slot that copies read from
+    uint32_t source_size;                           ///< How many bytes of the current slot copies may read
+    MX25RBlock first_block;                         ///< First 64KB block of the target slot
+    uint16_t block_count;                           ///< How many blocks the target slot has
+
+    MX25RUpdateCheckpoint state;                    ///< Progress so far, kept in checkpoint form so taking one is a copy
+    bool is_erasing;                                ///< If the next block erase was started and has not been verified
+    bool is_suspended;                              ///< If that erase is suspended so the bus can be used
+    bool has_failed;                                ///< If anything went wrong, the update has to start over
+
+    uint16_t page_fill;                             ///< How many bytes of the staging page are filled, the ones already programmed are 0xff
+    uint8_t page[MX25R_PAGE_SIZE];                  ///< Staging page for the next page of the new image
+
+} MX25RUpdate;
+
+/**
+ * @brief Starts a new update, the first block of the target slot starts erasing right away
+ * @note The slots must not overlap, copies read the current slot while the target slot is programmed
+ *
+ * @param[out] update: Update to start
+ * @param[in] dev: Device the slots are on
+ * @param[in] source: Address of the current slot
+ * @param[in] source_size: How many bytes of the current slot copies may read
+ * @param[in] first_block: First 64KB block of the target slot
+ * @param[in] block_count: How many blocks the target slot has
+ * @return MX25RUpdate*: NULL if it failed to start and update if it worked
+ */
+MX25RUpdate* MX25RUpdateBegin(MX25RUpdate* const update, MX25R* const dev, const uint32_t source, const uint32_t source_size, const MX25RBlock first_block, const uint16_t block_count);
+
+/**
+ * @brief Picks an interrupted update back up from a checkpoint, the delta has to be sent again from checkpoint->delta_offset
+ *
+ * @param[out] update: Update to resume
+ * @param[in] dev: Device the slots are on
+ * @param[in] source: Address of the current slot
+ * @param[in] source_size: How many bytes of the current slot copies may read
+ * @param[in] first_block: First 64KB block of the target slot
+ * @param[in] block_count: How many blocks the target slot has
+ * @param[in] checkpoint: Checkpoint taken with @ref MX25RUpdateTakeCheckpoint
+ * @return MX25RUpdate*: NULL if the checkpoint is not valid and update if it worked
+ */
+MX25RUpdate* MX25RUpdateResume(MX25RUpdate* const update, MX25R* const dev, const uint32_t source, const uint32_t source_size, const MX25RBlock first_block, const uint16_t block_count, const MX25RUpdateCheckpoint* const checkpoint);
+
+/**
+ * @brief Applies the next part of the delta, it can be cut anywhere, even in the middle of an op header
+ * @note Any running erase is suspended while this runs and resumed after, so it keeps going while the next part is on its way
+ *
+ * @param[in] update: Update to apply to
+ * @param[in] delta: Next bytes of the delta
+ * @param[in] size: How many bytes there are
+ * @return uint8_t: Status, 0 if the delta is bad, runs past either slot or the flash failed
+ */
+uint8_t MX25RUpdateWrite(MX25RUpdate* const update, const uint8_t* const delta, const uint32_t size);
+
+/**
+ * @brief Programs everything taken in so far and takes a checkpoint of it
+ *
+ * @param[in] update: Update to checkpoint
+ * @param[out] checkpoint: Where to put the checkpoint
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25RUpdateTakeCheckpoint(MX25RUpdate* const update, MX25RUpdateCheckpoint* const checkpoint);
+
+/**
+ * @brief Programs the rest of the new image and waits for any running erase
+ *
+ * @param[in] update: Update to finish
+ * @param[out] size: Where to put how many bytes the new image is, NULL if not needed
+ * @return uint8_t: Status, 0 if the delta ended in the middle of an op or there was an error
+ */
+uint8_t MX25RUpdateFinish(MX25RUpdate* const update, uint32_t* const size);
+
+#endif // include guard
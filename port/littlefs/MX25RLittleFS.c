@@ -0,0 +1,185 @@
+/**
+ * @file MX25RLittleFS.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the littlefs Block Device on the MX25R
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RLittleFS.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/// @brief What may still be running on the part when the next call comes in
+typedef enum MX25RLITTLEFSPENDING {
+
+    MX25R_LITTLEFS_IDLE,        ///< Nothing
+    MX25R_LITTLEFS_PROGRAM,     ///< A page program
+    MX25R_LITTLEFS_ERASE,       ///< A sector erase
+
+} MX25RLittleFSPending;
+
+/**
+ * @brief Waits for the last program or erase to land and checks it worked
+ *
+ * @param[in] fs: Block device to wait on
+ * @return int: LFS_ERR_OK, or LFS_ERR_IO if the program or erase failed
+ */
+static int MX25RLittleFSWait(MX25RLittleFS* const fs) {
+
+    if(fs->pending == MX25R_LITTLEFS_IDLE)
+        return LFS_ERR_OK;
+
+    while(MX25RIsWriteInProgress(fs->dev));
+
+    const bool worked = fs->pending == MX25R_LITTLEFS_PROGRAM ? MX25RVerifyProgram(fs->dev) : MX25RVerifyErase(fs->dev);
+    fs->pending = MX25R_LITTLEFS_IDLE;
+
+    return worked ? LFS_ERR_OK : LFS_ERR_IO;
+
+}
+
+/**
+ * @brief littlefs read, goes straight from the bus into littlefs's buffer
+ *
+ * @param[in] c: Config of the block device
+ * @param[in] block: Block to read from
+ * @param[in] off: Offset in the block
+ * @param[out] buffer: Where to read to
+ * @param[in] size: How many bytes to read
+ * @return int: LFS_ERR_OK, or a negative error code
+ */
+static int MX25RLittleFSRead(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, void* buffer, lfs_size_t size) {
+
+    MX25RLittleFS* const fs = (MX25RLittleFS*)c->context;
+
+    // the part ignores reads while a program or erase is running
+    const int err = MX25RLittleFSWait(fs);
+    if(err)
+        return err;
+
+    return MX25RFastRead(fs->dev, fs->base + block * c->block_size + off, (uint8_t*)buffer, size) ? LFS_ERR_OK : LFS_ERR_IO;
+
+}
+
+/**
+ * @brief littlefs program, a full page at a time since the program size is a page, the last page is left running
+ *
+ * @param[in] c: Config of the block device
+ * @param[in] block: Block to program
+ * @param[in] off: Offset in the block, page aligned
+ * @param[in] buffer: Data to program
+ * @param[in] size: How many bytes to program, whole pages
+ * @return int: LFS_ERR_OK, or a negative error code
+ */
+static int MX25RLittleFSProg(const struct lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size) {
+
+    MX25RLittleFS* const fs = (MX25RLittleFS*)c->context;
+    const uint8_t* const data = (const uint8_t*)buffer;
+
+    const MX25RPage first_page = (MX25RPage)((fs->base + block * c->block_size + off) / MX25R_PAGE_SIZE);
+
+    for(lfs_size_t done = 0; done < size; done += MX25R_PAGE_SIZE) {
+
+        const int err = MX25RLittleFSWait(fs);
+        if(err)
+            return err;
+
+        if(MX25REnableWriting(fs->dev) == 0 || MX25RPageProgram(fs->dev, (MX25RPage)(first_page + done / MX25R_PAGE_SIZE), data + done, MX25R_PAGE_SIZE) == 0)
+            return LFS_ERR_IO;
+
+        fs->pending = MX25R_LITTLEFS_PROGRAM;
+
+    }
+
+    return LFS_ERR_OK;
+
+}
+
+/**
+ * @brief littlefs erase, only starts the erase, the next call waits for it
+ *
+ * @param[in] c: Config of the block device
+ * @param[in] block: Block to erase
+ * @return int: LFS_ERR_OK, or a negative error code
+ */
+static int MX25RLittleFSErase(const struct lfs_config* c, lfs_block_t block) {
+
+    MX25RLittleFS* const fs = (MX25RLittleFS*)c->context;
+
+    const int err = MX25RLittleFSWait(fs);
+    if(err)
+        return err;
+
+    if(MX25REnableWriting(fs->dev) == 0 || MX25REraseSector(fs->dev, (MX25RSector)(fs->base / MX25R_SECTOR_SIZE + block)) == 0)
+        return LFS_ERR_IO;
+
+    fs->pending = MX25R_LITTLEFS_ERASE;
+
+    return LFS_ERR_OK;
+
+}
+
+/**
+ * @brief littlefs sync, makes sure the last program or erase landed
+ *
+ * @param[in] c: Config of the block device
+ * @return int: LFS_ERR_OK, or a negative error code
+ */
+static int MX25RLittleFSSync(const struct lfs_config* c) { return MX25RLittleFSWait((MX25RLittleFS*)c->context); }
+
+const struct lfs_config* MX25RLittleFSInit(MX25RLittleFS* const fs, MX25R* const dev, const MX25RSector first_sector, const uint16_t sector_count) {
+
+    if(fs == NULL || dev == NULL)
+        return NULL;
+
+    #ifdef MX25R_CAPACITY
+    const uint32_t total_sectors = MX25R_SECTOR_COUNT;
+    #else
+    MX25RID id;
+    if(MX25RReadID(dev, &id) == 0 || id.id.man_id != 0xc2 || id.id.mem_density < 0x14 || id.id.mem_density > 0x17)
+        return NULL;
+
+    const uint32_t total_sectors = (1ul << id.id.mem_density) / MX25R_SECTOR_SIZE;
+    #endif
+
+    if(first_sector >= total_sectors || sector_count > total_sectors - first_sector)
+        return NULL;
+
+    const uint32_t block_count = sector_count ? sector_count : total_sectors - first_sector;
+
+    fs->dev = dev;
+    fs->base = (uint32_t)first_sector * MX25R_SECTOR_SIZE;
+    fs->pending = MX25R_LITTLEFS_IDLE;
+
+    memset(&fs->config, 0, sizeof(fs->config));
+
+    fs->config.context = fs;
+    fs->config.read = MX25RLittleFSRead;
+    fs->config.prog = MX25RLittleFSProg;
+    fs->config.erase = MX25RLittleFSErase;
+    fs->config.sync = MX25RLittleFSSync;
+
+    // reads can start anywhere, programs are always full pages and a block is the smallest erase
+    fs->config.read_size = 1;
+    fs->config.prog_size = MX25R_PAGE_SIZE;
+    fs->config.block_size = MX25R_SECTOR_SIZE;
+    fs->config.block_count = block_count;
+    fs->config.block_cycles = MX25R_LITTLEFS_BLOCK_CYCLES;
+    fs->config.cache_size = MX25R_LITTLEFS_CACHE_SIZE;
+
+    // one bit per block so a single scan finds every free block, rounded up to the 8 bytes littlefs wants
+    uint32_t lookahead = ((block_count + 63) / 64) * 8;
+    fs->config.lookahead_size = lookahead > MX25R_LITTLEFS_LOOKAHEAD_MAX ? MX25R_LITTLEFS_LOOKAHEAD_MAX : lookahead;
+
+    fs->config.read_buffer = fs->read_buffer;
+    fs->config.prog_buffer = fs->prog_buffer;
+    fs->config.lookahead_buffer = fs->lookahead_buffer;
+
+    return &fs->config;
+
+}
@@ -0,0 +1,58 @@
+/**
+ * @file MX25RLittleFS.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for the littlefs Block Device on the MX25R
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_LITTLEFS_H
+#define MX25R_LITTLEFS_H
+
+#include "MX25R.h"
+#include "lfs.h"
+
+#ifndef MX25R_LITTLEFS_CACHE_SIZE
+#define MX25R_LITTLEFS_CACHE_SIZE       MX25R_PAGE_SIZE     ///< Size of the read and program caches, a multiple of the page size that divides a sector
+#endif
+
+#ifndef MX25R_LITTLEFS_LOOKAHEAD_MAX
+#define MX25R_LITTLEFS_LOOKAHEAD_MAX    256                 ///< Most bytes of lookahead bitmap, enough for every sector of the largest part
+#endif
+
+#ifndef MX25R_LITTLEFS_BLOCK_CYCLES
+#define MX25R_LITTLEFS_BLOCK_CYCLES     500                 ///< Erase cycles before littlefs moves metadata to another block to level wear
+#endif
+
+/// @brief A littlefs block device made of a range of sectors, a littlefs block is one sector
+typedef struct MX25RLITTLEFS {
+
+    MX25R* dev;                                                 ///< Device the file system is on
+    struct lfs_config config;                                   ///< Config to pass to lfs_mount and lfs_format
+    uint32_t base;                                              ///< Address of the first block
+    uint8_t pending;                                            ///< Program or erase that may still be running, checked before the next access
+
+    uint8_t read_buffer[MX25R_LITTLEFS_CACHE_SIZE];             ///< littlefs read cache, reads land here straight off the bus
+    uint8_t prog_buffer[MX25R_LITTLEFS_CACHE_SIZE];             ///< littlefs program cache, programmed straight from here
+    uint32_t lookahead_buffer[MX25R_LITTLEFS_LOOKAHEAD_MAX / 4];///< littlefs lookahead bitmap, word aligned
+
+} MX25RLittleFS;
+
+/**
+ * @brief Sets up a block device over a range of sectors and fills in a littlefs config for it
+ * @note Sizes are picked from the part, found from the ID unless a part is selected at compile time
+ *
+ * @param[out] fs: Block device to set up
+ * @param[in] dev: Device the file system lives on
+ * @param[in] first_sector: First sector of the file system
+ * @param[in] sector_count: How many sectors it has, 0 for every sector from first_sector to the end of the part
+ * @return const struct lfs_config*: Config to mount or format with, NULL if there was an error
+ */
+const struct lfs_config* MX25RLittleFSInit(MX25RLittleFS* const fs, MX25R* const dev, const MX25RSector first_sector, const uint16_t sector_count);
+
+#endif // include guard
@@ -10,9 +10,90 @@
  */
 
 #include "../include/MX25R.h"
+#include "../include/MX25RPower.h"
 
 #include <string.h>
 
+#ifdef MX25R_CAPACITY
+#define MX25R_DEV_CAPACITY(dev)     ((uint32_t)MX25R_CAPACITY)              ///< The part is fixed, so every limit folds to a constant
+#else
+#define MX25R_DEV_CAPACITY(dev)     ((uint32_t)(dev)->size_in_mb << 20)     ///< Only known at runtime from MX25RInit
+#endif
+
+#define MX25R_SHADOW_STATUS     (1 << 0)    ///< The status register shadow holds what the part has, apart from WIP and WEL
+#define MX25R_SHADOW_CONFIG     (1 << 1)    ///< The configuration register shadow holds what the part has
+#define MX25R_SHADOW_SECURITY   (1 << 2)    ///< The security register shadow holds what the part has
+#define MX25R_SHADOW_BURST      (1 << 3)    ///< The burst wrap shadow holds what was last sent
+
+#define MX25R_STATUS_WIP        (1 << 0)    ///< Write in progress bit of the status register
+#define MX25R_STATUS_WEL        (1 << 1)    ///< Write enable latch bit of the status register
+#define MX25R_BURST_DISABLED    0x10        ///< Burst wrap setting that turns wrap around off
+
+/**
+ * @brief Marks a program, erase or register write as started, WIP has to be read until it clears and the security register changes with the result
+ *
+ * @param[in] dev: Device the operation was started on
+ */
+static void MX25RStartedOperation(MX25R* const dev) {
+
+    // the part drops WEL once it is done
+    dev->is_write_en = false;
+    dev->is_busy = true;
+    dev->shadow_known &= (uint8_t)~MX25R_SHADOW_SECURITY;
+
+}
+
+/**
+ * @brief Selects the device for a command, waking it first if a power governor put it to sleep
+ *
+ * @param[in] dev: Device to select
+ */
+static void MX25RSelect(const MX25R* const dev) {
+
+    if(dev->power != NULL)
+        MX25RPowerOnCommand(dev->power);
+
+    dev->hal.select_chip(true);
+
+}
+
+/**
+ * @brief Gives back the write enable a governor mode change cleared, before a command that needs it is checked and sent
+ *
+ * @param[in] dev: Device about to be written
+ */
+static void MX25RRestoreWriting(MX25R* const dev) {
+
+    if(dev->power != NULL)
+        MX25RPowerRestoreWriting(dev->power);
+
+}
+
+/**
+ * @brief Writes a command packet to the device while it is selected
+ * 
+ * @param[in] dev: Device to write to 
+ * @param[in] cmd: Command to Send 
+ * @param[in] args: Arguments to that command, NULL if there are none 
+ * @param[in] arg_size: How many arguments are for the comamand 
+ * @return uint8_t: The status of the transfer, 0 if there was an error 
+ */
+static uint8_t MX25RSendCommand(const MX25R *const dev, const MX25RCommand cmd, const uint8_t *const args, const uint8_t arg_size) {
+
+    #ifdef DEBUG // we have to have a valid device and we can't have more than 5 args acoording to the datasheet
+    if(dev == NULL || arg_size > 4)
+        return 0;
+    #endif
+
+    static uint8_t buffer[5] = {0};
+    buffer[0] = cmd;
+    if(args != NULL)
+        memcpy(buffer + 1, args, arg_size);
+
+    return (uint8_t)dev->hal.spi_write(buffer, 1 + arg_size);
+
+}
+
 /**
  * @brief Actually sends the command to be executed with the parameters, selects the device, writes the command and unselects the device so it executes
  * 
@@ -25,12 +106,12 @@
 static uint8_t MX25RExecComplexCommand(const MX25R* const dev, const MX25RCommand command, const uint8_t* const args, const uint8_t args_size) {
 
     #ifdef DEBUG
-    if(dev == NULL || args == NULL)
+    if(dev == NULL)
         return 0;
     #endif
 
-    dev->hal.select_chip(true);
-    uint8_t out = MX25RWriteCommand(dev, command, args, args_size);
+    MX25RSelect(dev);
+    uint8_t out = MX25RSendCommand(dev, command, args, args_size);
     dev->hal.select_chip(false);
 
     return out;
@@ -57,16 +138,16 @@ static uint8_t MX25RExecSimpleCommand(const MX25R* const dev, const MX25RCommand
  * @param[in] size: How many bytes to write 
  * @return uint8_t: The Command Execution status, 0 if there was an error 
  */
-static uint8_t MX25RExecWritingCommand(const MX25R* const dev, const MX25RCommand command, const uint8_t* const args, const uint8_t args_size, const void* const buffer, const uint8_t size) {
+static uint8_t MX25RExecWritingCommand(const MX25R* const dev, const MX25RCommand command, const uint8_t* const args, const uint8_t args_size, const void* const buffer, const uint16_t size) {
 
     #ifdef DEBUG
     if(dev == NULL || buffer == NULL || size == 0 || dev->is_write_en == false)
         return 0;
     #endif
 
-    dev->hal.select_chip(true);
+    MX25RSelect(dev);
 
-    uint8_t ret = MX25RWriteCommand(dev, command, args, args_size);
+    uint8_t ret = MX25RSendCommand(dev, command, args, args_size);
     
     if(ret)
         dev->hal.spi_write(buffer, size);
@@ -86,14 +167,21 @@ static uint8_t MX25RExecWritingCommand(const MX25R* const dev, const MX25RComman
  * @param[in] args_size: The number of arguments for that command 
  * @return uint8_t: The command status, 0 if there was an error 
  */
-static uint8_t MX25RExecEraseCommand(const MX25R* const dev, const MX25RCommand cmd, const uint8_t* const args, const uint8_t args_size) {
+static uint8_t MX25RExecEraseCommand(MX25R* const dev, const MX25RCommand cmd, const uint8_t* const args, const uint8_t args_size) {
+
+    MX25RRestoreWriting(dev);
 
     #ifdef DEBUG
     if(dev->is_write_en == false)
         return 0;
     #endif
 
-    return MX25RExecComplexCommand(dev, cmd, args, args_size);
+    uint8_t ret = MX25RExecComplexCommand(dev, cmd, args, args_size);
+
+    if(ret)
+        MX25RStartedOperation(dev);
+
+    return ret;
 
 }
 
@@ -115,9 +203,9 @@ static uint8_t MX25RExecReadingCommand(const MX25R* const dev, const MX25RComman
         return 0;
     #endif
 
-    dev->hal.select_chip(true);
+    MX25RSelect(dev);
 
-    uint8_t ret = MX25RWriteCommand(dev, cmd, args, args_size);
+    uint8_t ret = MX25RSendCommand(dev, cmd, args, args_size);
     
     if(ret)
         dev->hal.spi_read(out, size);
@@ -128,41 +216,43 @@ static uint8_t MX25RExecReadingCommand(const MX25R* const dev, const MX25RComman
 
 }
 
-uint8_t MX25RWriteCommand(const MX25R *const dev, const MX25RCommand cmd, const uint8_t *const args, const uint8_t arg_size) {
+uint8_t MX25RWriteCommand(MX25R *const dev, const MX25RCommand cmd, const uint8_t *const args, const uint8_t arg_size) {
 
-    #ifdef DEBUG // we have to have a valid device and we can't have more than 5 args acoording to the datasheet
-    if(dev == NULL || arg_size > 4)
+    #ifdef DEBUG
+    if(dev == NULL)
         return 0;
     #endif
 
-    static uint8_t buffer[5] = {0};
-    buffer[0] = cmd;
-    if(args != NULL)
-        memcpy(buffer + 1, args, arg_size);
+    // whatever this does to the part is unknown, so WIP and the registers are read again
+    MX25RInvalidateShadow(dev);
 
-    return (uint8_t)dev->hal.spi_write(&cmd, 1 + arg_size);
+    return MX25RSendCommand(dev, cmd, args, arg_size);
 
 }
 
-#ifndef DEBUG
+#if !defined(DEBUG) || defined(MX25R_CAPACITY)
 MX25R* MX25RInit(MX25R *const dev, const MX25RHAL* const hal, const bool low_power) {
+
+    if(hal == NULL || dev == NULL)
+        return NULL;
 #else
 MX25R* MX25RInit(MX25R *const dev, const MX25RHAL* const hal, const bool low_power, const uint8_t size_in_mb) {
 
+    if(hal == NULL || dev == NULL)
+        return NULL;
 
-        
     dev->size_in_mb = size_in_mb;
-
-#endif   
-
-     if(hal == NULL || dev == NULL)
-        return NULL;
+#endif
 
     if(hal->select_chip == NULL || hal->spi_read == NULL || hal->spi_write == NULL)
         return NULL;
 
     dev->hal = *hal;
     dev->is_write_en = false;
+    dev->power = NULL;
+
+    // the part may still be busy from before we started, so WIP and the registers are read on the first query
+    MX25RInvalidateShadow(dev);
 
     return dev;
 
@@ -170,12 +260,15 @@ MX25R* MX25RInit(MX25R *const dev, const MX25RHAL* const hal, const bool low_pow
 
 void MX25RDeinit(MX25R* const dev) {
 
+    if(dev->power != NULL)
+        MX25RPowerDeinit(dev->power);
+
     MX25RDeepSleep(dev);
 
     dev->is_write_en = false;
     dev->hal = (MX25RHAL){ NULL, NULL, NULL };
     
-    #ifdef DEBUG
+    #if defined(DEBUG) && !defined(MX25R_CAPACITY)
     dev->size_in_mb = 0;
     #endif
 
@@ -185,8 +278,8 @@ uint8_t MX25RRead(const MX25R* const dev, const uint32_t address, uint8_t *const
 
     #ifdef DEBUG
     // if the address if bigger than the flash itself or we want to read past the end or we dont have a valid
-    const uint32_t max_address = (dev->size_in_mb << 20) - 1;
-    if(address > max_address || size > (max_addres - address) || output == NULL)
+    const uint32_t capacity = MX25R_DEV_CAPACITY(dev);
+    if(address >= capacity || size > capacity - address || output == NULL)
         return 0;
     #endif
 
@@ -201,17 +294,28 @@ uint8_t MX25RReadStatus(MX25R* const dev, MX25RStatus* const status) {
         return 0;
     #endif
 
-    uint8_t raw_status[] = {0, 0};
+    uint8_t ret = 1;
+
+    // with nothing running WIP is clear and WEL is whatever the driver last set it to, so there is nothing to read
+    if(dev->is_busy || !(dev->shadow_known & MX25R_SHADOW_STATUS)) {
+
+        ret = MX25RExecReadingCommand(dev, MX25R_READ_STAT_REG, NULL, 0, &dev->status, 1);
 
-    uint8_t ret = MX25RExecReadingCommand(dev, MX25R_READ_STAT_REG, NULL, 0, raw_status, 1);
+        if(ret) {
+            dev->shadow_known |= MX25R_SHADOW_STATUS;
+            dev->is_busy = dev->status & MX25R_STATUS_WIP;
+            dev->is_write_en = dev->status & MX25R_STATUS_WEL;
+        }
 
-    status->write_in_progress = raw_status[0] & (1 << 0);
-    status->block_protection_level = (raw_status[0] >> 2) & 0xf;
-    status->write_enabled =  raw_status[0] & (1 << 1);
-    status->status_register_write_protected = raw_status[0] & (1 << 7);
-    status->quad_mode_enable = raw_status[0] & (1 << 2);
+    }
+    else
+        dev->status = (uint8_t)((dev->status & ~(MX25R_STATUS_WIP | MX25R_STATUS_WEL)) | (dev->is_write_en ? MX25R_STATUS_WEL : 0));
 
-    dev->is_write_en = status->write_enabled;
+    status->write_in_progress = dev->status & (1 << 0);
+    status->block_protection_level = (dev->status >> 2) & 0xf;
+    status->write_enabled = dev->status & (1 << 1);
+    status->status_register_write_protected = dev->status & (1 << 7);
+    status->quad_mode_enable = dev->status & (1 << 6);
 
     return ret;
 }
@@ -237,32 +341,42 @@ uint8_t MX25RFastRead(const MX25R* const dev, const uint32_t address, uint8_t* c
 
     #ifdef DEBUG
     // if the address if bigger than the flash itself or we want to read past the end or we dont have a valid
-    const uint32_t max_address = (dev->size_in_mb << 20) - 1;
-    if(address > max_address || size > (max_addres - address) || output == NULL)
+    const uint32_t capacity = MX25R_DEV_CAPACITY(dev);
+    if(address >= capacity || size > capacity - address || output == NULL)
         return 0;
     #endif
 
     uint8_t fast_read_args[] = { (uint8_t)(address >> 16), (uint8_t)(address >> 8), address & 0xff, 0 };
-    return MX25RExecReadingCommand(dev, MX25R_FAST_READ, fast_read_args, 3, output, size);
+    return MX25RExecReadingCommand(dev, MX25R_FAST_READ, fast_read_args, 4, output, size);
 
 }
 
-uint8_t MX25RReadSecurityReg(const MX25R* const dev, MX25RSecurityReg* const reg) {
+uint8_t MX25RReadSecurityReg(MX25R* const dev, MX25RSecurityReg* const reg) {
 
     #ifdef DEBUG
     if(reg == NULL)
         return 0;
     #endif
     
-    uint8_t raw_reg = 0;
-    uint8_t ret = MX25RExecReadingCommand(dev, MX25R_READ_SEC_REG, NULL, 0, &raw_reg, 1);
+    uint8_t ret = 1;
+
+    // it only changes with a program, erase, suspend, resume or OTP lock, so one read after each is enough
+    if(!(dev->shadow_known & MX25R_SHADOW_SECURITY)) {
+
+        ret = MX25RExecReadingCommand(dev, MX25R_READ_SEC_REG, NULL, 0, &dev->security, 1);
 
-    reg->erase_failed = raw_reg & (1 << 6);
-    reg->erase_suspended = raw_reg & (1 << 3);
-    reg->program_failed = raw_reg & (1 << 5);
-    reg->program_suspended = raw_reg & (1 << 2);
-    reg->otp_sector1_locked = raw_reg & (1 << 1);
-    reg->otp_sector2_locked = raw_reg & (1 << 0);
+        // while something runs the result bits are not final yet
+        if(ret && !dev->is_busy)
+            dev->shadow_known |= MX25R_SHADOW_SECURITY;
+
+    }
+
+    reg->erase_failed = dev->security & (1 << 6);
+    reg->erase_suspended = dev->security & (1 << 3);
+    reg->program_failed = dev->security & (1 << 5);
+    reg->program_suspended = dev->security & (1 << 2);
+    reg->otp_sector1_locked = dev->security & (1 << 1);
+    reg->otp_sector2_locked = dev->security & (1 << 0);
 
     return ret;
 
@@ -270,145 +384,225 @@ uint8_t MX25RReadSecurityReg(const MX25R* const dev, MX25RSecurityReg* const reg
 
 uint8_t MX25RReadConfig(MX25R* const dev, MX25RConfig* const config) {
 
-    uint8_t buffer[2];
-    uint8_t res = MX25RExecReadingCommand(dev, MX25R_READ_CONFIG_REG, NULL, 0, buffer, 2);
+    uint8_t res = 1;
+
+    // only the driver changes it, so it is read once
+    if(!(dev->shadow_known & MX25R_SHADOW_CONFIG)) {
+
+        res = MX25RExecReadingCommand(dev, MX25R_READ_CONFIG_REG, NULL, 0, dev->config, 2);
+        if(res)
+            dev->shadow_known |= MX25R_SHADOW_CONFIG;
+
+    }
     
-    config->dummy_cycle = buffer[0] & (1 << 6);
-    config->top_bottom = buffer[0] & (1 << 3); 
-    config->low_power_mode = !buffer[1] & (1 << 1);
+    config->dummy_cycle = dev->config[0] & (1 << 6);
+    config->top_bottom = dev->config[0] & (1 << 3); 
+    config->low_power_mode = !(dev->config[1] & (1 << 1));
 
     return res;
 }
 
-uint8_t MX25RWriteSecurityReg(const MX25R* const dev, bool lockdown_otp_sector1) {
+uint8_t MX25RWriteSecurityReg(MX25R* const dev, bool lockdown_otp_sector1) {
 
     uint8_t res = 1;
-    if(lockdown_otp_sector1) 
+    if(lockdown_otp_sector1) {
+
+        MX25RRestoreWriting(dev);
+
         res = MX25RExecSimpleCommand(dev, MX25R_WRITE_SEC_REG);
+        if(res)
+            MX25RStartedOperation(dev);
+
+    }
     
     return res;
 }
 
-uint8_t MX25RWriteStatusConfigReg(const MX25R* const dev, const MX25RStatus* const status, const MX25RConfig* const config) {
+uint8_t MX25RWriteStatusConfig(MX25R* const dev, const MX25RStatus* const status, const MX25RConfig* const config) {
 
     uint8_t status_config[3] = { 
-        status->write_in_progress | (status->write_enabled << 1) | (status->block_protection_level << 2) | (status->quad_mode_enable << 6) | (status->status_register_write_protected),
-        (config->dummy_cycle << 6) | (config->top_bottom << 3),
-        ((!config->low_power_mode) << 1)
+        (uint8_t)(status->write_in_progress | (status->write_enabled << 1) | (status->block_protection_level << 2) | (status->quad_mode_enable << 6) | (status->status_register_write_protected << 7)),
+        (uint8_t)((config->dummy_cycle << 6) | (config->top_bottom << 3)),
+        (uint8_t)((!config->low_power_mode) << 1)
     };
 
-    return MX25RExecComplexCommand(dev, MX25R_WRITE_STAT_REG, status_config, 3);
+    MX25RRestoreWriting(dev);
+
+    uint8_t ret = MX25RExecComplexCommand(dev, MX25R_WRITE_STAT_REG, status_config, 3);
+
+    // the part ignores the write without WEL, so only then does the shadow change
+    if(ret && dev->is_write_en) {
+
+        dev->status = (uint8_t)((dev->status & (MX25R_STATUS_WIP | MX25R_STATUS_WEL)) | (status_config[0] & ~(MX25R_STATUS_WIP | MX25R_STATUS_WEL)));
+        dev->config[0] = status_config[1];
+        dev->config[1] = status_config[2];
+        dev->shadow_known |= MX25R_SHADOW_STATUS | MX25R_SHADOW_CONFIG;
+
+        MX25RStartedOperation(dev);
+
+    }
+
+    return ret;
 }
 
-uint8_t MX25RPageProgram(const MX25R* const dev, const uint16_t page, const uint8_t *const data, const uint8_t size) {
+uint8_t MX25RPageProgram(MX25R* const dev, const MX25RPage page, const uint8_t *const data, const uint16_t size) {
 
     #ifdef DEBUG
-    const uint16_t max_page = (dev->size_in_mb << 20) / MX25R_PAGE_SIZE;
-    if(page > max_page || data == NULL || dev->flags.write_enabled = false)
+    if(page >= MX25R_DEV_CAPACITY(dev) / MX25R_PAGE_SIZE || data == NULL || size > MX25R_PAGE_SIZE)
         return 0;
     #endif
 
+    MX25RRestoreWriting(dev);
+
     uint8_t page_program_args[3] = {(uint8_t)(page >> 8), (uint8_t)(page & 0xff), 0};
-    return MX25RExecWritingCommand(dev, MX25R_PAGE_PROG, page_program_args, 3, data, size);
+    uint8_t ret = MX25RExecWritingCommand(dev, MX25R_PAGE_PROG, page_program_args, 3, data, size);
+
+    if(ret)
+        MX25RStartedOperation(dev);
+
+    return ret;
 }
 
-uint8_t MX25REraseSector(const MX25R* const dev, const uint16_t sector) {
+uint8_t MX25REraseSector(MX25R* const dev, const MX25RSector sector) {
 
     #ifdef DEBUG
-    const uint16_t max_sector = (dev->size_in_mb << 20) / MX25R_SECTOR_SIZE;
-    if(sector > max_sector)
+    if(sector >= MX25R_DEV_CAPACITY(dev) / MX25R_SECTOR_SIZE)
         return 0;
     #endif
 
-    const uint8_t erase_sector_args[] = { 0, (sector >> 8), sector & 0xff };
+    const uint8_t erase_sector_args[] = { (uint8_t)(sector >> 4), (uint8_t)(sector << 4), 0 };
     return MX25RExecEraseCommand(dev, MX25R_SECT_ERASE, erase_sector_args, 3);
 
 }
 
-uint8_t MX25REraseBlock32K(const MX25R* const dev, const uint8_t block) {
+uint8_t MX25REraseBlock32K(MX25R* const dev, const MX25RSmallBlock block) {
 
     #ifdef DEBUG
-    const uint8_t max_small_block = (dev->size_in_mb << 20) / MX25R_SMALL_BLOCK_SIZE;
-    if(block > max_small_block)
+    if(block >= MX25R_DEV_CAPACITY(dev) / MX25R_SMALL_BLOCK_SIZE)
         return 0;
     #endif
 
-    const uint8_t erase_block_args[] = { 0, 0, block };
+    const uint8_t erase_block_args[] = { (uint8_t)(block >> 1), (uint8_t)(block << 7), 0 };
     return MX25RExecEraseCommand(dev, MX25R_BLOCK_ERASE32K, erase_block_args, 3);
 }
 
-uint8_t MX25REraseBlock(const MX25R* const dev, const uint8_t block) {
+uint8_t MX25REraseBlock(MX25R* const dev, const MX25RBlock block) {
 
     #ifdef DEBUG
-    const uint8_t max_block = (dev->size_in_mb << 20) / MX25R_BLOCK_SIZE;
-    if(block > max_block)
+    if(block >= MX25R_DEV_CAPACITY(dev) / MX25R_BLOCK_SIZE)
         return 0;
     #endif
 
-    const uint8_t erase_block_args[] = { 0, 0, block };
+    const uint8_t erase_block_args[] = { block, 0, 0 };
     return MX25RExecEraseCommand(dev, MX25R_BLOCK_ERASE, erase_block_args, 3);
 
 }
 
-uint8_t MX25REnableBurstRead(const MX25R* const dev, const uint8_t wrap_length) {
+uint8_t MX25REnableBurstRead(MX25R* const dev, const uint8_t wrap_length) {
 
     #ifdef DEBUG 
     if(wrap_length > 3)
         return 0;
     #endif
 
-    return MX25RExecComplexCommand(dev, MX25R_SET_BURST_LEN, &wrap_length, 1);
+    if((dev->shadow_known & MX25R_SHADOW_BURST) && dev->burst == wrap_length)
+        return 1;
+
+    uint8_t ret = MX25RExecComplexCommand(dev, MX25R_SET_BURST_LEN, &wrap_length, 1);
+    if(ret) {
+        dev->burst = wrap_length;
+        dev->shadow_known |= MX25R_SHADOW_BURST;
+    }
+
+    return ret;
 
 }
 
-uint8_t MX25RDisableBurstRead(const MX25R* const dev) {
+uint8_t MX25RDisableBurstRead(MX25R* const dev) {
+
+    if((dev->shadow_known & MX25R_SHADOW_BURST) && dev->burst == MX25R_BURST_DISABLED)
+        return 1;
+
+    static const uint8_t burst_disable = MX25R_BURST_DISABLED;
+    uint8_t ret = MX25RExecComplexCommand(dev, MX25R_SET_BURST_LEN, &burst_disable, 1);
+    if(ret) {
+        dev->burst = MX25R_BURST_DISABLED;
+        dev->shadow_known |= MX25R_SHADOW_BURST;
+    }
 
-    static const uint8_t burst_disable = 0x10;
-    return MX25RExecComplexCommand(dev, MX25R_SET_BURST_LEN, &burst_disable, 1);
+    return ret;
 
 }
 
-uint8_t MX25REraseChip(const MX25R* const dev) { return MX25RExecEraseCommand(dev, MX25R_FLASH_ERASE, NULL, 0); }
+uint8_t MX25REraseChip(MX25R* const dev) { return MX25RExecEraseCommand(dev, MX25R_FLASH_ERASE, NULL, 0); }
+
+uint8_t MX25RDeepSleep(const MX25R* const dev) {
 
-uint8_t MX25RDeepSleep(const MX25R* const dev) { return MX25RExecSimpleCommand(dev, MX25R_DEEP_SLEEP); }
+    uint8_t ret = MX25RExecSimpleCommand(dev, MX25R_DEEP_SLEEP);
 
-uint8_t MX25RSetLowPowerMode(const MX25R* const dev, const bool enabled)  {
+    // the governor wakes it again on the next command
+    if(ret && dev->power != NULL)
+        dev->power->is_asleep = true;
+
+    return ret;
+
+}
+
+uint8_t MX25RSetLowPowerMode(MX25R* const dev, const bool enabled)  {
 
     MX25RStatus stat;
     MX25RConfig config;
 
-    MX25RReadStatus(dev, &stat);
-    MX25RReadConfig(dev, &config);
+    if(MX25RReadConfig(dev, &config) == 0)
+        return 0;
 
-    config.low_power_mode = !enabled;
+    // already there, nothing to write
+    if(config.low_power_mode == enabled)
+        return 1;
 
-    return MX25RWriteStatusConfigReg(dev, &stat, &config);
+    if(MX25RReadStatus(dev, &stat) == 0 || MX25REnableWriting(dev) == 0)
+        return 0;
+
+    config.low_power_mode = enabled;
+
+    return MX25RWriteStatusConfig(dev, &stat, &config);
 
 }
 
 uint8_t MX25REnableWriting(MX25R* const dev)  {
 
+    // the caller's own write enable replaces any the governor still had to give back
+    if(dev->power != NULL)
+        dev->power->is_restoring_write_en = false;
+
     dev->is_write_en = true;
     return MX25RExecSimpleCommand(dev, MX25R_WRITE_EN);
 }
 
 uint8_t MX25RDisableWriting(MX25R* const dev)  {
 
+    if(dev->power != NULL)
+        dev->power->is_restoring_write_en = false;
+
     dev->is_write_en = false;
     return MX25RExecSimpleCommand(dev, MX25R_WRITE_DIS);
 }
 
-bool MX25RIsWritingEnabled(const MX25R* const dev) { return dev->is_write_en; }
+bool MX25RIsWritingEnabled(const MX25R* const dev) { return dev->is_write_en || (dev->power != NULL && dev->power->is_restoring_write_en); }
 
 bool MX25RIsWriteInProgress(MX25R* const dev) {
     
+    // nothing was started since WIP last read clear
+    if(!dev->is_busy)
+        return false;
+
     MX25RStatus stat = {0};
     MX25RReadStatus(dev, &stat);
     return stat.write_in_progress;
 
 }
 
-bool MX25RVerifyErase(const MX25R* const dev)  {
+bool MX25RVerifyErase(MX25R* const dev)  {
 
     MX25RSecurityReg reg;
     MX25RReadSecurityReg(dev, &reg);
@@ -416,7 +610,7 @@ bool MX25RVerifyErase(const MX25R* const dev)  {
 
 }
 
-bool MX25RVerifyProgram(const MX25R* const dev) {
+bool MX25RVerifyProgram(MX25R* const dev) {
 
     MX25RSecurityReg reg;
     MX25RReadSecurityReg(dev, &reg);
@@ -427,11 +621,30 @@ bool MX25RVerifyProgram(const MX25R* const dev) {
 uint8_t MX25RReset(MX25R* const dev) { 
 
     dev->is_write_en = false;   
-    return MX25RExecSimpleCommand(dev, MX25R_RESET_EN) && MX25RExecSimpleCommand(dev, MX25R_RESET); 
+
+    // a reset puts the part back in ultra low power mode with write enable cleared
+    if(dev->power != NULL) {
+        dev->power->is_high_performance = false;
+        dev->power->is_restoring_write_en = false;
+    }
+
+    uint8_t ret = MX25RExecSimpleCommand(dev, MX25R_RESET_EN) && MX25RExecSimpleCommand(dev, MX25R_RESET); 
+
+    // volatile settings go back to their defaults, so everything is read again
+    MX25RInvalidateShadow(dev);
+
+    return ret;
     
 }
 
-bool MX25RIsOTPRegionLocked(const MX25R* const dev) { 
+void MX25RInvalidateShadow(MX25R* const dev) {
+
+    dev->shadow_known = 0;
+    dev->is_busy = true;
+
+}
+
+bool MX25RIsOTPRegionLocked(MX25R* const dev) { 
     
     MX25RSecurityReg reg = {0};
     MX25RReadSecurityReg(dev, &reg);
@@ -443,6 +656,25 @@ uint8_t MX25REnterOTPRegion(const MX25R* const dev) { return MX25RExecSimpleComm
 
 uint8_t MX25RExitOTPRegion(const MX25R* const dev)  { return MX25RExecSimpleCommand(dev, MX25R_EXIT_OTP); }
 
-uint8_t MX25RSuspend(const MX25R* const dev) { return MX25RExecSimpleCommand(dev, MX25R_SUSPEND); }
+uint8_t MX25RSuspend(MX25R* const dev) { 
 
-uint8_t MX25RResume(const MX25R* const dev) { return MX25RExecSimpleCommand(dev, MX25R_RESUME); }
+    uint8_t ret = MX25RExecSimpleCommand(dev, MX25R_SUSPEND);
+
+    // the suspend takes a moment to land and it changes the suspended bits
+    if(ret)
+        MX25RStartedOperation(dev);
+
+    return ret;
+
+}
+
+uint8_t MX25RResume(MX25R* const dev) { 
+
+    uint8_t ret = MX25RExecSimpleCommand(dev, MX25R_RESUME);
+
+    if(ret)
+        MX25RStartedOperation(dev);
+
+    return ret;
+
+}
@@ -0,0 +1,823 @@
+/**
+ * @file MX25RCompress.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the MX25R Compressed Region Layer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "../include/MX25RCompress.h"
+#include "../include/MX25RCrc.h"
+
+#include <string.h>
+
+#define MX25R_COMPRESS_MAGIC        0x5a43  ///< Marks the start of a frame header
+#define MX25R_COMPRESS_MIN_MATCH    4       ///< Shortest match the codec encodes
+#define MX25R_COMPRESS_LAST_LITERALS 5      ///< The codec always ends a frame with at least this many literals
+#define MX25R_COMPRESS_MATCH_LIMIT  12      ///< No match may start within this many bytes of the end of the frame
+
+#define MX25R_PAGES_PER_SECTOR      (MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE)
+
+/// @brief The decoded form of the header at the start of each stored frame
+typedef struct MX25RCOMPRESSHEADER {
+
+    uint16_t frame;         ///< Which frame this is
+    uint16_t raw_size;      ///< How many bytes the frame holds uncompressed
+    uint16_t stored_size;   ///< How many bytes follow the header, equal to raw_size if the frame is stored uncompressed
+    uint16_t data_crc;      ///< CRC16 of the stored bytes
+    uint32_t sequence;      ///< When the frame was stored, the copy with the highest sequence is the live one
+
+} MX25RCompressHeader;
+
+/**
+ * @brief Reads a little endian 32 bit word from a byte buffer
+ *
+ * @param[in] data: Where to read from
+ * @return uint32_t: The word
+ */
+static uint32_t MX25RCompressLoad32(const uint8_t* const data) {
+
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+
+}
+
+/**
+ * @brief Writes the extra bytes of a length that did not fit in its token nibble
+ *
+ * @param[out] dst: Where to write the length bytes
+ * @param[in] length: The length minus the 15 that the nibble already holds
+ * @return uint32_t: How many bytes were written
+ */
+static uint32_t MX25RCompressPutLength(uint8_t* const dst, uint32_t length) {
+
+    uint32_t written = 0;
+
+    for(; length >= 255; length -= 255)
+        dst[written++] = 255;
+
+    dst[written++] = (uint8_t)length;
+
+    return written;
+
+}
+
+/**
+ * @brief Writes one LZ4 style sequence, the literals since the last match followed by a match
+ *
+ * @param[out] dst: Where to write the sequence
+ * @param[in] capacity: How many bytes are left in dst
+ * @param[in] literals: The literal bytes
+ * @param[in] literal_count: How many literal bytes there are
+ * @param[in] offset: How far back the match starts, 0 if this is the final sequence and has no match
+ * @param[in] match_length: How long the match is, ignored if offset is 0
+ * @return uint32_t: How many bytes were written, 0 if it did not fit
+ */
+static uint32_t MX25RCompressPutSequence(uint8_t* const dst, const uint32_t capacity, const uint8_t* const literals, const uint32_t literal_count, const uint16_t offset, const uint32_t match_length) {
+
+    const uint32_t match_code = offset ? match_length - MX25R_COMPRESS_MIN_MATCH : 0;
+    const uint32_t worst_case = 1 + literal_count / 255 + 1 + literal_count + (offset ? 2 + match_code / 255 + 1 : 0);
+
+    if(worst_case > capacity)
+        return 0;
+
+    uint32_t written = 1;
+    dst[0] = (uint8_t)(((literal_count < 15 ? literal_count : 15) << 4) | (match_code < 15 ? match_code : 15));
+
+    if(literal_count >= 15)
+        written += MX25RCompressPutLength(dst + written, literal_count - 15);
+
+    memcpy(dst + written, literals, literal_count);
+    written += literal_count;
+
+    if(offset == 0)
+        return written;
+
+    dst[written++] = (uint8_t)offset;
+    dst[written++] = (uint8_t)(offset >> 8);
+
+    if(match_code >= 15)
+        written += MX25RCompressPutLength(dst + written, match_code - 15);
+
+    return written;
+
+}
+
+/**
+ * @brief Compresses a frame with a single pass greedy LZ4 style match finder
+ *
+ * @param[in] hash: Match finder table, 1 << MX25R_COMPRESS_HASH_BITS entries
+ * @param[in] src: Data to compress
+ * @param[in] size: How many bytes to compress
+ * @param[out] dst: Where to put the compressed data
+ * @param[in] capacity: How many bytes fit in dst
+ * @return uint32_t: How many compressed bytes there are, 0 if they did not fit in capacity
+ */
+static uint32_t MX25RCompressFrame(uint16_t* const hash, const uint8_t* const src, const uint32_t size, uint8_t* const dst, const uint32_t capacity) {
+
+    // the table holds position + 1 so that 0 means empty, frames can't share matches
+    memset(hash, 0, sizeof(uint16_t) << MX25R_COMPRESS_HASH_BITS);
+
+    uint32_t in = 0, anchor = 0, out = 0;
+
+    if(size > MX25R_COMPRESS_MATCH_LIMIT) {
+
+        const uint32_t match_start_limit = size - MX25R_COMPRESS_MATCH_LIMIT;
+        const uint32_t match_end_limit = size - MX25R_COMPRESS_LAST_LITERALS;
+
+        while(in < match_start_limit) {
+
+            const uint32_t sequence = MX25RCompressLoad32(src + in);
+            const uint32_t slot = (sequence * 2654435761u) >> (32 - MX25R_COMPRESS_HASH_BITS);
+            const uint32_t candidate = hash[slot];
+
+            hash[slot] = (uint16_t)(in + 1);
+
+            if(candidate == 0 || MX25RCompressLoad32(src + candidate - 1) != sequence) {
+                in++;
+                continue;
+            }
+
+            const uint32_t match = candidate - 1;
+            uint32_t length = MX25R_COMPRESS_MIN_MATCH;
+            while(in + length < match_end_limit && src[match + length] == src[in + length])
+                length++;
+
+            const uint32_t written = MX25RCompressPutSequence(dst + out, capacity - out, src + anchor, in - anchor, (uint16_t)(in - match), length);
+            if(written == 0)
+                return 0;
+
+            out += written;
+            in += length;
+            anchor = in;
+
+        }
+
+    }
+
+    const uint32_t written = MX25RCompressPutSequence(dst + out, capacity - out, src + anchor, size - anchor, 0, 0);
+    if(written == 0)
+        return 0;
+
+    return out + written;
+
+}
+
+/**
+ * @brief Reads the extra bytes of a length whose token nibble was 15
+ *
+ * @param[in] src: Compressed data
+ * @param[in] size: How many bytes are in src
+ * @param[in,out] in: Where we are in src, advanced past the length bytes
+ * @param[in,out] length: The length so far, the extra bytes are added to it
+ * @return uint8_t: Status, 0 if the length ran past the end of src
+ */
+static uint8_t MX25RDecompressGetLength(const uint8_t* const src, const uint32_t size, uint32_t* const in, uint32_t* const length) {
+
+    uint8_t byte;
+
+    do {
+
+        if(*in >= size)
+            return 0;
+
+        byte = src[(*in)++];
+        *length += byte;
+
+    } while(byte == 255);
+
+    return 1;
+
+}
+
+/**
+ * @brief Decompresses a frame, never reads or writes outside the given buffers no matter what the input is
+ *
+ * @param[in] src: Compressed data
+ * @param[in] size: How many compressed bytes there are
+ * @param[out] dst: Where to put the decompressed data
+ * @param[in] capacity: How many bytes fit in dst
+ * @return uint32_t: How many bytes were decompressed, 0 if the data was corrupt
+ */
+static uint32_t MX25RDecompressFrame(const uint8_t* const src, const uint32_t size, uint8_t* const dst, const uint32_t capacity) {
+
+    uint32_t in = 0, out = 0;
+
+    while(in < size) {
+
+        const uint8_t token = src[in++];
+
+        uint32_t literal_count = token >> 4;
+        if(literal_count == 15 && MX25RDecompressGetLength(src, size, &in, &literal_count) == 0)
+            return 0;
+
+        if(literal_count > size - in || literal_count > capacity - out)
+            return 0;
+
+        memcpy(dst + out, src + in, literal_count);
+        in += literal_count;
+        out += literal_count;
+
+        // the final sequence is only literals
+        if(in == size)
+            break;
+
+        if(size - in < 2)
+            return 0;
+
+        const uint32_t offset = (uint32_t)src[in] | ((uint32_t)src[in + 1] << 8);
+        in += 2;
+
+        if(offset == 0 || offset > out)
+            return 0;
+
+        uint32_t length = token & 0xf;
+        if(length == 15 && MX25RDecompressGetLength(src, size, &in, &length) == 0)
+            return 0;
+
+        length += MX25R_COMPRESS_MIN_MATCH;
+        if(length > capacity - out)
+            return 0;
+
+        // matches can overlap what they produce, so this has to go a byte at a time
+        for(uint32_t i = 0; i < length; i++, out++)
+            dst[out] = dst[out - offset];
+
+    }
+
+    return out;
+
+}
+
+/**
+ * @brief Writes a header into the first bytes of a frame as it will be laid out on flash
+ *
+ * @param[out] raw: Where to write the header, MX25R_COMPRESS_HEADER_SIZE bytes
+ * @param[in] header: Header to write
+ */
+static void MX25RCompressPutHeader(uint8_t* const raw, const MX25RCompressHeader* const header) {
+
+    const uint16_t fields[] = { MX25R_COMPRESS_MAGIC, header->frame, header->raw_size, header->stored_size, header->data_crc };
+
+    for(uint8_t i = 0; i < 5; i++) {
+        raw[2 * i] = (uint8_t)fields[i];
+        raw[2 * i + 1] = (uint8_t)(fields[i] >> 8);
+    }
+
+    for(uint8_t i = 0; i < 4; i++)
+        raw[10 + i] = (uint8_t)(header->sequence >> (8 * i));
+
+    const uint16_t header_crc = MX25RCrc16(MX25R_CRC16_INIT, raw, MX25R_COMPRESS_HEADER_SIZE - 2);
+    raw[14] = (uint8_t)header_crc;
+    raw[15] = (uint8_t)(header_crc >> 8);
+
+}
+
+/**
+ * @brief Decodes and validates a header read from flash
+ *
+ * @param[in] raw: The MX25R_COMPRESS_HEADER_SIZE bytes of the header
+ * @param[out] header: Where to put the decoded header
+ * @return uint8_t: Status, 0 if this is not a valid header
+ */
+static uint8_t MX25RCompressGetHeader(const uint8_t* const raw, MX25RCompressHeader* const header) {
+
+    uint16_t fields[5];
+    for(uint8_t i = 0; i < 5; i++)
+        fields[i] = (uint16_t)(raw[2 * i] | (raw[2 * i + 1] << 8));
+
+    const uint16_t header_crc = (uint16_t)(raw[14] | (raw[15] << 8));
+    if(fields[0] != MX25R_COMPRESS_MAGIC || header_crc != MX25RCrc16(MX25R_CRC16_INIT, raw, MX25R_COMPRESS_HEADER_SIZE - 2))
+        return 0;
+
+    header->frame = fields[1];
+    header->raw_size = fields[2];
+    header->stored_size = fields[3];
+    header->data_crc = fields[4];
+    header->sequence = MX25RCompressLoad32(raw + 10);
+
+    if(header->raw_size == 0 || header->raw_size > MX25R_COMPRESS_FRAME_SIZE || header->stored_size > MX25R_COMPRESS_MAX_STORED)
+        return 0;
+
+    return 1;
+
+}
+
+/**
+ * @brief Gets how many pages a frame takes up on flash
+ *
+ * @param[in] stored_size: How many bytes follow the header
+ * @return uint32_t: The number of pages
+ */
+static uint32_t MX25RCompressFramePages(const uint32_t stored_size) { return (MX25R_COMPRESS_HEADER_SIZE + stored_size + MX25R_PAGE_SIZE - 1) / MX25R_PAGE_SIZE; }
+
+/**
+ * @brief Gets the absolute page number of a page in the region
+ *
+ * @param[in] region: Region the page is in
+ * @param[in] page: Page relative to the start of the region
+ * @return uint32_t: The absolute page number
+ */
+static uint32_t MX25RCompressPage(const MX25RCompressRegion* const region, const uint32_t page) { return (uint32_t)region->first_sector * MX25R_PAGES_PER_SECTOR + page; }
+
+/**
+ * @brief Gets how many sectors of the ring are erased and not in use, the sectors after the head up to the tail
+ *
+ * @param[in] region: Region to check
+ * @return uint16_t: The number of free sectors, one of them is the spare kept for reclaiming
+ */
+static uint16_t MX25RCompressFreeSectors(const MX25RCompressRegion* const region) { return (uint16_t)(region->sector_count - 1 - (region->head + region->sector_count - region->tail) % region->sector_count); }
+
+/**
+ * @brief Reads the header at a page of the region
+ *
+ * @param[in] region: Region the page is in
+ * @param[in] page: Page relative to the start of the region
+ * @param[out] raw: Where to read the header bytes to
+ * @param[out] header: Where to put the decoded header
+ * @return uint8_t: 1 if there is a valid header for a frame of this region, 0 if not or the read failed
+ */
+static uint8_t MX25RCompressReadHeader(const MX25RCompressRegion* const region, const uint32_t page, uint8_t* const raw, MX25RCompressHeader* const header) {
+
+    if(MX25RFastRead(region->dev, MX25RCompressPage(region, page) * MX25R_PAGE_SIZE, raw, MX25R_COMPRESS_HEADER_SIZE) == 0)
+        return 0;
+
+    return MX25RCompressGetHeader(raw, header) && header->frame < region->frame_count;
+
+}
+
+/**
+ * @brief Programs one page and waits for it to land
+ *
+ * @param[in] dev: Device to program
+ * @param[in] page: Absolute page to program
+ * @param[in] data: Data to program
+ * @param[in] size: How many bytes to program
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RCompressProgramPage(MX25R* const dev, const uint32_t page, const uint8_t* const data, const uint16_t size) {
+
+    if(MX25REnableWriting(dev) == 0 || MX25RPageProgram(dev, (MX25RPage)page, data, size) == 0)
+        return 0;
+
+    while(MX25RIsWriteInProgress(dev));
+
+    return MX25RVerifyProgram(dev);
+
+}
+
+/**
+ * @brief Erases one sector of the region and waits for it
+ *
+ * @param[in] region: Region the sector is in
+ * @param[in] sector: Sector relative to the start of the region
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RCompressEraseSector(MX25RCompressRegion* const region, const uint16_t sector) {
+
+    if(MX25REnableWriting(region->dev) == 0 || MX25REraseSector(region->dev, (MX25RSector)(region->first_sector + sector)) == 0)
+        return 0;
+
+    while(MX25RIsWriteInProgress(region->dev));
+
+    return MX25RVerifyErase(region->dev);
+
+}
+
+/**
+ * @brief Checks if a page in the region reads back as erased
+ *
+ * @param[in] region: Region the page is in
+ * @param[in] page: Page relative to the start of the region
+ * @return true: If the page is erased
+ * @return false: If anything on the page was programmed
+ */
+static bool MX25RCompressIsPageBlank(MX25RCompressRegion* const region, const uint32_t page) {
+
+    // the raw buffer is borrowed, so whatever frame was cached there is gone
+    region->cached_frame = MX25R_COMPRESS_NO_FRAME;
+
+    if(MX25RFastRead(region->dev, MX25RCompressPage(region, page) * MX25R_PAGE_SIZE, region->raw, MX25R_PAGE_SIZE) == 0)
+        return false;
+
+    for(uint16_t i = 0; i < MX25R_PAGE_SIZE; i++)
+        if(region->raw[i] != 0xff)
+            return false;
+
+    return true;
+
+}
+
+/**
+ * @brief Moves the head to the next sector of the ring, erasing it first if a cut erase or a torn frame left anything on it
+ *
+ * @param[in] region: Region to advance
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RCompressEnterSector(MX25RCompressRegion* const region) {
+
+    const uint16_t next = (uint16_t)((region->head + 1) % region->sector_count);
+
+    for(uint32_t page = 0; page < MX25R_PAGES_PER_SECTOR; page++) {
+
+        if(MX25RCompressIsPageBlank(region, (uint32_t)next * MX25R_PAGES_PER_SECTOR + page))
+            continue;
+
+        if(MX25RCompressEraseSector(region, next) == 0)
+            return 0;
+
+        break;
+
+    }
+
+    region->head = next;
+    region->write_page = (uint32_t)next * MX25R_PAGES_PER_SECTOR;
+
+    return 1;
+
+}
+
+/**
+ * @brief Programs the frame laid out in the packed buffer at the write page, the header goes on its own last so a frame only becomes visible to a mount once all of it has landed
+ *
+ * @param[in] region: Region to append to, the frame has to fit in the head sector
+ * @param[in] frame: Which frame it is
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RCompressAppend(MX25RCompressRegion* const region, const uint16_t frame) {
+
+    const uint32_t total_size = MX25R_COMPRESS_HEADER_SIZE + (uint32_t)(region->packed[6] | (region->packed[7] << 8));
+    const uint32_t pages = (total_size + MX25R_PAGE_SIZE - 1) / MX25R_PAGE_SIZE;
+
+    for(uint32_t page = 1; page < pages; page++) {
+
+        const uint32_t offset = page * MX25R_PAGE_SIZE;
+        const uint16_t chunk = (uint16_t)(total_size - offset < MX25R_PAGE_SIZE ? total_size - offset : MX25R_PAGE_SIZE);
+
+        if(MX25RCompressProgramPage(region->dev, MX25RCompressPage(region, region->write_page + page), region->packed + offset, chunk) == 0)
+            return 0;
+
+    }
+
+    // the rest of the first page goes with the header left erased, a page cut halfway would otherwise leave a valid header over missing data
+    uint8_t header[MX25R_COMPRESS_HEADER_SIZE];
+    memcpy(header, region->packed, MX25R_COMPRESS_HEADER_SIZE);
+    memset(region->packed, 0xff, MX25R_COMPRESS_HEADER_SIZE);
+
+    const uint32_t first_page = MX25RCompressPage(region, region->write_page);
+    const uint16_t first_chunk = (uint16_t)(total_size < MX25R_PAGE_SIZE ? total_size : MX25R_PAGE_SIZE);
+
+    const uint8_t status = MX25RCompressProgramPage(region->dev, first_page, region->packed, first_chunk);
+    memcpy(region->packed, header, MX25R_COMPRESS_HEADER_SIZE);
+
+    if(status == 0 || MX25RCompressProgramPage(region->dev, first_page, header, MX25R_COMPRESS_HEADER_SIZE) == 0)
+        return 0;
+
+    region->index[frame] = (uint16_t)region->write_page;
+    region->write_page += pages;
+    region->sequence++;
+
+    return 1;
+
+}
+
+/**
+ * @brief Checks if a frame of some pages fits in what is left of the head sector
+ *
+ * @param[in] region: Region to check
+ * @param[in] pages: How many pages the frame takes
+ * @return true: If it fits
+ * @return false: If the head has to move on first
+ */
+static bool MX25RCompressFits(const MX25RCompressRegion* const region, const uint32_t pages) { return region->write_page + pages <= ((uint32_t)region->head + 1) * MX25R_PAGES_PER_SECTOR; }
+
+/**
+ * @brief Moves the live frames out of the tail sector to the head and erases it, the moved copies get new sequence numbers so they win over the old ones
+ * @note Runs with at least one free sector, which is all the live frames of one sector can take
+ *
+ * @param[in] region: Region to reclaim from, the tail must not be the head
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RCompressReclaim(MX25RCompressRegion* const region) {
+
+    const uint32_t first = (uint32_t)region->tail * MX25R_PAGES_PER_SECTOR;
+
+    for(uint32_t page = first; page < first + MX25R_PAGES_PER_SECTOR;) {
+
+        MX25RCompressHeader header;
+        if(MX25RCompressReadHeader(region, page, region->packed, &header) == 0) {
+            page++;
+            continue;
+        }
+
+        const uint32_t pages = MX25RCompressFramePages(header.stored_size);
+
+        if(region->index[header.frame] == page) {
+
+            const uint32_t address = MX25RCompressPage(region, page) * MX25R_PAGE_SIZE + MX25R_COMPRESS_HEADER_SIZE;
+            if(MX25RFastRead(region->dev, address, region->packed + MX25R_COMPRESS_HEADER_SIZE, header.stored_size) == 0)
+                return 0;
+
+            header.sequence = region->sequence;
+            MX25RCompressPutHeader(region->packed, &header);
+
+            if(!MX25RCompressFits(region, pages) && (MX25RCompressFreeSectors(region) == 0 || MX25RCompressEnterSector(region) == 0))
+                return 0;
+
+            if(MX25RCompressAppend(region, header.frame) == 0)
+                return 0;
+
+        }
+
+        page += pages;
+
+    }
+
+    if(MX25RCompressEraseSector(region, region->tail) == 0)
+        return 0;
+
+    region->tail = (uint16_t)((region->tail + 1) % region->sector_count);
+
+    return 1;
+
+}
+
+/**
+ * @brief Compresses a frame and lays it out in the packed buffer behind its header, with the next sequence number
+ *
+ * @param[in] region: Region the frame goes to
+ * @param[in] frame: Which frame it is
+ * @param[in] data: Uncompressed frame contents
+ * @param[in] size: How many bytes are in the frame
+ * @return uint32_t: How many pages it takes on flash
+ */
+static uint32_t MX25RCompressPack(MX25RCompressRegion* const region, const uint16_t frame, const uint8_t* const data, const uint16_t size) {
+
+    uint8_t* const stored = region->packed + MX25R_COMPRESS_HEADER_SIZE;
+    uint32_t stored_size = MX25RCompressFrame(region->hash, data, size, stored, size - 1);
+
+    // data that does not shrink is kept as is, so a frame never costs more than its raw size plus the header
+    if(stored_size == 0) {
+        memcpy(stored, data, size);
+        stored_size = size;
+    }
+
+    const MX25RCompressHeader header = { frame, size, (uint16_t)stored_size, MX25RCrc16(MX25R_CRC16_INIT, stored, stored_size), region->sequence };
+    MX25RCompressPutHeader(region->packed, &header);
+
+    return MX25RCompressFramePages(stored_size);
+
+}
+
+MX25RCompressRegion* MX25RCompressMount(MX25RCompressRegion* const region, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, uint16_t* const index, const uint16_t frame_count) {
+
+    // page offsets share the index with MX25R_COMPRESS_NO_FRAME, so the region has to stay under 65535 pages
+    if(region == NULL || dev == NULL || index == NULL || sector_count < 3 || sector_count >= 0x1000 || frame_count == 0)
+        return NULL;
+
+    region->dev = dev;
+    region->first_sector = first_sector;
+    region->sector_count = sector_count;
+    region->index = index;
+    region->frame_count = frame_count;
+    region->cached_frame = MX25R_COMPRESS_NO_FRAME;
+    region->cached_size = 0;
+
+    for(uint16_t i = 0; i < frame_count; i++)
+        index[i] = MX25R_COMPRESS_NO_FRAME;
+
+    const uint32_t total_pages = (uint32_t)sector_count * MX25R_PAGES_PER_SECTOR;
+
+    // the newest frame is in the head sector, and the sectors after it in the ring are the oldest
+    bool is_empty = true;
+    region->head = 0;
+    region->sequence = 0;
+
+    for(uint32_t page = 0; page < total_pages;) {
+
+        MX25RCompressHeader header;
+        if(MX25RCompressReadHeader(region, page, region->packed, &header) == 0) {
+            page++;
+            continue;
+        }
+
+        if(is_empty || header.sequence >= region->sequence) {
+            region->head = (uint16_t)(page / MX25R_PAGES_PER_SECTOR);
+            region->sequence = header.sequence + 1;
+            is_empty = false;
+        }
+
+        page += MX25RCompressFramePages(header.stored_size);
+
+    }
+
+    // replay from the oldest sector, so a later copy of a frame replaces an earlier one, a torn frame or a header cut short is stepped over
+    region->tail = region->head;
+    bool is_tail_found = false;
+
+    for(uint16_t step = 1; step <= sector_count; step++) {
+
+        const uint16_t sector = (uint16_t)((region->head + step) % sector_count);
+        const uint32_t first = (uint32_t)sector * MX25R_PAGES_PER_SECTOR;
+
+        for(uint32_t page = first; page < first + MX25R_PAGES_PER_SECTOR;) {
+
+            MX25RCompressHeader header;
+            if(MX25RCompressReadHeader(region, page, region->packed, &header) == 0) {
+                page++;
+                continue;
+            }
+
+            index[header.frame] = (uint16_t)page;
+            page += MX25RCompressFramePages(header.stored_size);
+
+            if(!is_tail_found) {
+                region->tail = sector;
+                is_tail_found = true;
+            }
+
+        }
+
+    }
+
+    // append after the last page anything landed on in the head, torn frames included, so nothing is ever programmed twice
+    const uint32_t head_start = (uint32_t)region->head * MX25R_PAGES_PER_SECTOR;
+    uint32_t page = head_start + MX25R_PAGES_PER_SECTOR;
+
+    while(page > head_start && MX25RCompressIsPageBlank(region, page - 1))
+        page--;
+
+    region->write_page = page;
+
+    return region;
+
+}
+
+uint8_t MX25RCompressFormat(MX25RCompressRegion* const region) {
+
+    #ifdef DEBUG
+    if(region == NULL)
+        return 0;
+    #endif
+
+    for(uint16_t sector = 0; sector < region->sector_count; sector++)
+        if(MX25RCompressEraseSector(region, sector) == 0)
+            return 0;
+
+    for(uint16_t i = 0; i < region->frame_count; i++)
+        region->index[i] = MX25R_COMPRESS_NO_FRAME;
+
+    region->write_page = 0;
+    region->sequence = 0;
+    region->head = 0;
+    region->tail = 0;
+    region->cached_frame = MX25R_COMPRESS_NO_FRAME;
+
+    return 1;
+
+}
+
+uint8_t MX25RCompressWriteFrame(MX25RCompressRegion* const region, const uint16_t frame, const uint8_t* const data, const uint16_t size) {
+
+    #ifdef DEBUG
+    if(region == NULL || data == NULL)
+        return 0;
+    #endif
+
+    if(frame >= region->frame_count || size == 0 || size > MX25R_COMPRESS_FRAME_SIZE)
+        return 0;
+
+    uint32_t pages = MX25RCompressPack(region, frame, data, size);
+
+    // the last free sector is kept for reclaiming, so once only it is left the oldest sector is reclaimed first
+    for(uint16_t reclaimed = 0; !MX25RCompressFits(region, pages);) {
+
+        if(MX25RCompressFreeSectors(region) >= 2) {
+
+            if(MX25RCompressEnterSector(region) == 0)
+                return 0;
+
+            continue;
+
+        }
+
+        // a sector full of live frames frees nothing when it is moved, so give up once every sector went round
+        if(region->tail == region->head || reclaimed++ >= region->sector_count)
+            return 0;
+
+        if(MX25RCompressReclaim(region) == 0)
+            return 0;
+
+        // moving frames used the packed buffer and took sequence numbers
+        pages = MX25RCompressPack(region, frame, data, size);
+
+    }
+
+    if(MX25RCompressAppend(region, frame) == 0)
+        return 0;
+
+    if(region->cached_frame == frame)
+        region->cached_frame = MX25R_COMPRESS_NO_FRAME;
+
+    return 1;
+
+}
+
+/**
+ * @brief Makes sure a frame is decompressed into the raw buffer
+ *
+ * @param[in] region: Region the frame is in
+ * @param[in] frame: Frame to load
+ * @return uint8_t: Status, 0 if there was an error or the frame was corrupt
+ */
+static uint8_t MX25RCompressLoadFrame(MX25RCompressRegion* const region, const uint16_t frame) {
+
+    if(region->cached_frame == frame)
+        return 1;
+
+    region->cached_frame = MX25R_COMPRESS_NO_FRAME;
+
+    const uint16_t page = region->index[frame];
+    if(page == MX25R_COMPRESS_NO_FRAME) {
+
+        region->cached_frame = frame;
+        region->cached_size = 0;
+        return 1;
+
+    }
+
+    const uint32_t address = MX25RCompressPage(region, page) * MX25R_PAGE_SIZE;
+    if(MX25RFastRead(region->dev, address, region->packed, MX25R_COMPRESS_HEADER_SIZE) == 0)
+        return 0;
+
+    MX25RCompressHeader header;
+    if(MX25RCompressGetHeader(region->packed, &header) == 0 || header.frame != frame)
+        return 0;
+
+    uint8_t* const stored = region->packed + MX25R_COMPRESS_HEADER_SIZE;
+    if(MX25RFastRead(region->dev, address + MX25R_COMPRESS_HEADER_SIZE, stored, header.stored_size) == 0)
+        return 0;
+
+    if(MX25RCrc16(MX25R_CRC16_INIT, stored, header.stored_size) != header.data_crc)
+        return 0;
+
+    if(header.stored_size == header.raw_size)
+        memcpy(region->raw, stored, header.raw_size);
+    else if(MX25RDecompressFrame(stored, header.stored_size, region->raw, MX25R_COMPRESS_FRAME_SIZE) != header.raw_size)
+        return 0;
+
+    region->cached_frame = frame;
+    region->cached_size = header.raw_size;
+
+    return 1;
+
+}
+
+uint8_t MX25RCompressRead(MX25RCompressRegion* const region, const uint32_t address, uint8_t* const output, const uint32_t size) {
+
+    #ifdef DEBUG
+    if(region == NULL || output == NULL)
+        return 0;
+    #endif
+
+    const uint32_t logical_size = (uint32_t)region->frame_count * MX25R_COMPRESS_FRAME_SIZE;
+    if(address > logical_size || size > logical_size - address)
+        return 0;
+
+    uint32_t done = 0;
+    while(done < size) {
+
+        const uint32_t position = address + done;
+        const uint16_t frame = (uint16_t)(position / MX25R_COMPRESS_FRAME_SIZE);
+        const uint32_t offset = position % MX25R_COMPRESS_FRAME_SIZE;
+        const uint32_t chunk = (size - done < MX25R_COMPRESS_FRAME_SIZE - offset) ? size - done : MX25R_COMPRESS_FRAME_SIZE - offset;
+
+        if(MX25RCompressLoadFrame(region, frame) == 0)
+            return 0;
+
+        // whatever is past the end of a short frame reads as erased flash would
+        const uint32_t valid = offset < region->cached_size ? region->cached_size - offset : 0;
+        const uint32_t copied = valid < chunk ? valid : chunk;
+
+        memcpy(output + done, region->raw + offset, copied);
+        memset(output + done + copied, 0xff, chunk - copied);
+
+        done += chunk;
+
+    }
+
+    return 1;
+
+}
+
+uint32_t MX25RCompressFreePages(const MX25RCompressRegion* const region) {
+
+    const uint16_t free_sectors = MX25RCompressFreeSectors(region);
+    const uint32_t head_pages = ((uint32_t)region->head + 1) * MX25R_PAGES_PER_SECTOR - region->write_page;
+
+    // the spare sector only ever takes frames moved out by a reclaim
+    return head_pages + (free_sectors > 1 ? (uint32_t)(free_sectors - 1) * MX25R_PAGES_PER_SECTOR : 0);
+
+}
@@ -0,0 +1,33 @@
+/**
+ * @file MX25RCrc.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the Checksums used to validate data stored on the MX25R
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "../include/MX25RCrc.h"
+
+uint16_t MX25RCrc16(uint16_t crc, const void* const data, const uint32_t size) {
+
+    // a nibble wide table keeps it fast without spending 512 bytes of flash on a full table
+    static const uint16_t nibble_table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+        0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+    };
+
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    for(uint32_t i = 0; i < size; i++) {
+
+        crc = (uint16_t)(crc << 4) ^ nibble_table[(crc >> 12) ^ (bytes[i] >> 4)];
+        crc = (uint16_t)(crc << 4) ^ nibble_table[(crc >> 12) ^ (bytes[i] & 0xf)];
+
+    }
+
+    return crc;
+
+}
@@ -0,0 +1,740 @@
+/**
+ * @file MX25RIndex.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the MX25R Record Log with a Per-Sector Key Summary Index
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "../include/MX25RIndex.h"
+#include "../include/MX25RCrc.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define MX25R_PAGES_PER_SECTOR      (MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE)
+#define MX25R_INDEX_ENTRY_SIZE      16                                          ///< Size of a summary table entry
+#define MX25R_INDEX_ENTRIES         (MX25R_SECTOR_SIZE / MX25R_INDEX_ENTRY_SIZE) ///< How many entries a table sector holds
+#define MX25R_INDEX_PAGE_ENTRIES    (MX25R_PAGE_SIZE / MX25R_INDEX_ENTRY_SIZE)  ///< How many entries a page holds
+#define MX25R_INDEX_KIND_SHIFT      14                                          ///< Where the kind sits in an entry's sector field
+#define MX25R_INDEX_SECTOR_MASK     ((1 << MX25R_INDEX_KIND_SHIFT) - 1)         ///< The sector part of an entry's sector field
+
+/// @brief A summary table entry as it is on flash, a sector's newest entry by sequence number is the one that counts
+typedef struct MX25RINDEXENTRY {
+
+    uint32_t sequence;      ///< Increases with every entry written, 0xffffffff for an erased slot
+    uint32_t min_key;       ///< Smallest key in the sector
+    uint32_t max_key;       ///< Largest key in the sector
+    uint16_t sector;        ///< Data sector in the low bits and the MX25RIndexKind in the top 2
+    uint16_t crc;           ///< CRC16 over everything before it
+
+} MX25RIndexEntry;
+
+/**
+ * @brief Gets the key of a record
+ *
+ * @param[in] record: Record to look at
+ * @return uint32_t: Its key
+ */
+static uint32_t MX25RIndexKey(const uint8_t* const record) {
+
+    uint32_t key;
+    memcpy(&key, record, sizeof(key));
+    return key;
+
+}
+
+/**
+ * @brief Checks a record slot read from flash holds a whole record, a slot torn by a power loss or never written fails
+ *
+ * @param[in] index: Log the slot belongs to
+ * @param[in] slot: The record followed by its CRC16
+ * @return true: If the record is whole
+ * @return false: If it is erased or torn
+ */
+static bool MX25RIndexIsIntact(const MX25RIndex* const index, const uint8_t* const slot) {
+
+    const uint16_t crc = (uint16_t)(slot[index->record_size] | (slot[index->record_size + 1] << 8));
+    return MX25RIndexKey(slot) != MX25R_INDEX_EMPTY_KEY && crc == MX25RCrc16(MX25R_CRC16_INIT, slot, index->record_size);
+
+}
+
+/**
+ * @brief Checks if a record slot read from flash is still erased
+ *
+ * @param[in] index: Log the slot belongs to
+ * @param[in] slot: The slot to check
+ * @return true: If every byte of it is erased
+ * @return false: If anything in it was programmed
+ */
+static bool MX25RIndexIsBlank(const MX25RIndex* const index, const uint8_t* const slot) {
+
+    for(uint16_t i = 0; i < index->slot_size; i++)
+        if(slot[i] != 0xff)
+            return false;
+
+    return true;
+
+}
+
+/**
+ * @brief Marks which records in a run have a key in range, four keys at a time with SSE2
+ *
+ * @param[in] records: First record
+ * @param[in] count: How many records there are
+ * @param[in] stride: Size of each record
+ * @param[in] min_key: Smallest key to match
+ * @param[in] max_key: Largest key to match
+ * @param[out] matches: One bit per record, set if it matched
+ * @return uint32_t: How many records matched
+ */
+static uint32_t MX25RIndexFilter(const uint8_t* const records, const uint32_t count, const uint32_t stride, const uint32_t min_key, const uint32_t max_key, uint8_t* const matches) {
+
+    uint32_t i = 0, matched = 0;
+    memset(matches, 0, (count + 7) / 8);
+
+    #if defined(__SSE2__)
+
+    // SSE2 only compares signed, flipping the top bit turns the unsigned compare into a signed one
+    const __m128i bias = _mm_set1_epi32((int32_t)0x80000000);
+    const __m128i low = _mm_set1_epi32((int32_t)(min_key ^ 0x80000000));
+    const __m128i high = _mm_set1_epi32((int32_t)(max_key ^ 0x80000000));
+
+    for(; i + 4 <= count; i += 4) {
+
+        uint32_t keys[4];
+        for(uint8_t j = 0; j < 4; j++)
+            keys[j] = MX25RIndexKey(records + (i + j) * stride);
+
+        const __m128i key = _mm_xor_si128(_mm_loadu_si128((const __m128i*)keys), bias);
+        const __m128i out = _mm_or_si128(_mm_cmpgt_epi32(low, key), _mm_cmpgt_epi32(key, high));
+        const uint32_t hits = ~(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(out)) & 0xf;
+
+        matches[i / 8] |= (uint8_t)(hits << (i % 8));
+        matched += (hits & 1) + ((hits >> 1) & 1) + ((hits >> 2) & 1) + (hits >> 3);
+
+    }
+
+    #endif
+
+    for(; i < count; i++) {
+
+        const uint32_t key = MX25RIndexKey(records + i * stride);
+
+        if(key >= min_key && key <= max_key) {
+            matches[i / 8] |= (uint8_t)(1 << (i % 8));
+            matched++;
+        }
+
+    }
+
+    return matched;
+
+}
+
+/**
+ * @brief Waits for the program or erase that was just started and checks it
+ *
+ * @param[in] index: Log that started it
+ * @param[in] is_erase: If it was an erase
+ * @return uint8_t: Status, 0 if it failed
+ */
+static uint8_t MX25RIndexWait(MX25RIndex* const index, const bool is_erase) {
+
+    while(MX25RIsWriteInProgress(index->dev));
+    return is_erase ? MX25RVerifyErase(index->dev) : MX25RVerifyProgram(index->dev);
+
+}
+
+/**
+ * @brief Erases a sector of the region and waits for it
+ *
+ * @param[in] index: Log the region belongs to
+ * @param[in] sector: Sector relative to the start of the region
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexErase(MX25RIndex* const index, const uint16_t sector) {
+
+    if(MX25REnableWriting(index->dev) == 0 || MX25REraseSector(index->dev, (MX25RSector)(index->first_sector + sector)) == 0)
+        return 0;
+
+    return MX25RIndexWait(index, true);
+
+}
+
+/**
+ * @brief Programs a run of entries into consecutive slots of a table sector with one page program
+ *
+ * @param[in] index: Log the table belongs to
+ * @param[in] table: Which table sector
+ * @param[in] slot: Which entry of that sector the first one goes to
+ * @param[in] entries: Entries to program
+ * @param[in] count: How many entries there are, they all have to land in the page of the first one
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexProgramEntries(MX25RIndex* const index, const uint8_t table, const uint16_t slot, const MX25RIndexEntry* const entries, const uint16_t count) {
+
+    // the rest of the page is 0xff so the entries around them are left as they are
+    memset(index->scan, 0xff, MX25R_PAGE_SIZE);
+    memcpy(index->scan + (slot * MX25R_INDEX_ENTRY_SIZE) % MX25R_PAGE_SIZE, entries, count * sizeof(*entries));
+
+    const MX25RPage page = (MX25RPage)((index->first_sector + table) * MX25R_PAGES_PER_SECTOR + slot * MX25R_INDEX_ENTRY_SIZE / MX25R_PAGE_SIZE);
+
+    if(MX25REnableWriting(index->dev) == 0 || MX25RPageProgram(index->dev, page, index->scan, MX25R_PAGE_SIZE) == 0)
+        return 0;
+
+    return MX25RIndexWait(index, false);
+
+}
+
+/**
+ * @brief Programs one entry into a slot of a table sector
+ *
+ * @param[in] index: Log the table belongs to
+ * @param[in] table: Which table sector
+ * @param[in] slot: Which entry of that sector
+ * @param[in] entry: Entry to program
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexProgramEntry(MX25RIndex* const index, const uint8_t table, const uint16_t slot, const MX25RIndexEntry* const entry) { return MX25RIndexProgramEntries(index, table, slot, entry, 1); }
+
+/**
+ * @brief Builds an on flash entry
+ *
+ * @param[out] entry: Entry to fill in
+ * @param[in] sequence: Its sequence number
+ * @param[in] kind: What it says about the sector
+ * @param[in] sector: Data sector it is about
+ * @param[in] min_key: Smallest key in the sector
+ * @param[in] max_key: Largest key in the sector
+ */
+static void MX25RIndexMakeEntry(MX25RIndexEntry* const entry, const uint32_t sequence, const MX25RIndexKind kind, const uint16_t sector, const uint32_t min_key, const uint32_t max_key) {
+
+    entry->sequence = sequence;
+    entry->min_key = min_key;
+    entry->max_key = max_key;
+    entry->sector = (uint16_t)((kind << MX25R_INDEX_KIND_SHIFT) | (sector & MX25R_INDEX_SECTOR_MASK));
+    entry->crc = MX25RCrc16(MX25R_CRC16_INIT, entry, offsetof(MX25RIndexEntry, crc));
+
+}
+
+/**
+ * @brief Rewrites the newest entry of every sector into the other table sector so the table has room again
+ * @note The table sector being written to always holds the whole state, so it is only erased after the other one does too
+ *
+ * @param[in] index: Log to compact the table of
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexCompact(MX25RIndex* const index) {
+
+    const uint8_t other = index->table ^ 1;
+    if(MX25RIndexErase(index, other) == 0)
+        return 0;
+
+    MX25RIndexEntry entries[MX25R_INDEX_PAGE_ENTRIES];
+    uint16_t slot = 0, batched = 0;
+
+    // the other sector starts erased, so the entries fill it a page at a time and each page goes out in one program
+    for(uint16_t sector = 0; sector < index->data_count; sector++) {
+
+        const MX25RIndexSummary* const summary = index->summary + sector;
+        if(summary->sequence == 0)
+            continue;
+
+        MX25RIndexMakeEntry(entries + batched++, summary->sequence, (MX25RIndexKind)summary->kind, sector, summary->min_key, summary->max_key);
+
+        if(batched == MX25R_INDEX_PAGE_ENTRIES) {
+
+            if(MX25RIndexProgramEntries(index, other, slot, entries, batched) == 0)
+                return 0;
+
+            slot += batched;
+            batched = 0;
+
+        }
+
+    }
+
+    if(batched != 0) {
+
+        if(MX25RIndexProgramEntries(index, other, slot, entries, batched) == 0)
+            return 0;
+
+        slot += batched;
+
+    }
+
+    // only now does the new table sector count as holding everything, it goes out on its own so a torn program can't mark a table whose entries did not all land
+    MX25RIndexEntry entry;
+    MX25RIndexMakeEntry(&entry, ++index->sequence, MX25R_INDEX_TABLE, 0, 0, 0);
+    if(MX25RIndexProgramEntry(index, other, slot++, &entry) == 0)
+        return 0;
+
+    index->table = other;
+    index->table_next = slot;
+
+    return 1;
+
+}
+
+/**
+ * @brief Logs a new summary table entry for a data sector and updates the RAM copy
+ *
+ * @param[in] index: Log to update
+ * @param[in] kind: What the entry says about the sector
+ * @param[in] sector: Data sector it is about
+ * @param[in] min_key: Smallest key in the sector
+ * @param[in] max_key: Largest key in the sector
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexLog(MX25RIndex* const index, const MX25RIndexKind kind, const uint16_t sector, const uint32_t min_key, const uint32_t max_key) {
+
+    if(index->table_next >= MX25R_INDEX_ENTRIES && MX25RIndexCompact(index) == 0)
+        return 0;
+
+    MX25RIndexEntry entry;
+    MX25RIndexMakeEntry(&entry, ++index->sequence, kind, sector, min_key, max_key);
+
+    if(MX25RIndexProgramEntry(index, index->table, index->table_next++, &entry) == 0)
+        return 0;
+
+    index->summary[sector] = (MX25RIndexSummary){ entry.sequence, min_key, max_key, (uint8_t)kind };
+
+    return 1;
+
+}
+
+/**
+ * @brief Erases a data sector and makes it the one records are appended to, logging it first so its old summary is never trusted again
+ *
+ * @param[in] index: Log to update
+ * @param[in] sector: Data sector to open
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexOpen(MX25RIndex* const index, const uint16_t sector) {
+
+    if(MX25RIndexLog(index, MX25R_INDEX_OPENING, sector, MX25R_INDEX_EMPTY_KEY, 0) == 0)
+        return 0;
+
+    if(MX25RIndexErase(index, MX25R_INDEX_TABLE_SECTORS + sector) == 0)
+        return 0;
+
+    if(MX25RIndexLog(index, MX25R_INDEX_OPEN, sector, MX25R_INDEX_EMPTY_KEY, 0) == 0)
+        return 0;
+
+    index->open_sector = sector;
+    index->open_count = 0;
+    index->open_min = MX25R_INDEX_EMPTY_KEY;
+    index->open_max = 0;
+    index->written = 0;
+    index->page_fill = 0;
+    memset(index->page, 0xff, MX25R_PAGE_SIZE);
+
+    return 1;
+
+}
+
+/**
+ * @brief Programs the staging page into the open sector, a partial page leaves the rest of the page to be programmed later
+ *
+ * @param[in] index: Log to program
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexProgram(MX25RIndex* const index) {
+
+    const uint32_t base = index->written & ~(uint32_t)(MX25R_PAGE_SIZE - 1);
+
+    if(base + index->page_fill == index->written)
+        return 1;
+
+    // the bytes programmed before are 0xff in the staging page, programming them again leaves them as they are
+    const MX25RPage page = (MX25RPage)((index->first_sector + MX25R_INDEX_TABLE_SECTORS + index->open_sector) * MX25R_PAGES_PER_SECTOR + base / MX25R_PAGE_SIZE);
+
+    if(MX25REnableWriting(index->dev) == 0 || MX25RPageProgram(index->dev, page, index->page, index->page_fill) == 0)
+        return 0;
+
+    if(MX25RIndexWait(index, false) == 0)
+        return 0;
+
+    index->written = base + index->page_fill;
+
+    if(index->page_fill == MX25R_PAGE_SIZE)
+        index->page_fill = 0;
+
+    memset(index->page, 0xff, index->page_fill ? index->page_fill : MX25R_PAGE_SIZE);
+
+    return 1;
+
+}
+
+/**
+ * @brief Adds bytes to the staging page, programming it each time it fills up
+ *
+ * @param[in] index: Log to append to
+ * @param[in] data: Bytes to add
+ * @param[in] size: How many bytes there are
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexStage(MX25RIndex* const index, const uint8_t* const data, const uint16_t size) {
+
+    for(uint16_t done = 0; done < size;) {
+
+        uint16_t count = MX25R_PAGE_SIZE - index->page_fill;
+        if(count > size - done)
+            count = size - done;
+
+        memcpy(index->page + index->page_fill, data + done, count);
+        index->page_fill += count;
+        done += count;
+
+        if(index->page_fill == MX25R_PAGE_SIZE && MX25RIndexProgram(index) == 0)
+            return 0;
+
+    }
+
+    return 1;
+
+}
+
+/**
+ * @brief Reads part of a data sector, including records of the open sector that are still in the staging page
+ *
+ * @param[in] index: Log to read
+ * @param[in] sector: Data sector to read
+ * @param[in] offset: Where in the sector to start
+ * @param[in] size: How many bytes to read into the scan buffer
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexLoad(MX25RIndex* const index, const uint16_t sector, const uint32_t offset, const uint32_t size) {
+
+    const uint32_t address = (uint32_t)(index->first_sector + MX25R_INDEX_TABLE_SECTORS + sector) * MX25R_SECTOR_SIZE + offset;
+    if(MX25RFastRead(index->dev, address, index->scan, size) == 0)
+        return 0;
+
+    if(sector != index->open_sector)
+        return 1;
+
+    // overlay what is staged but not programmed yet
+    const uint32_t base = index->written & ~(uint32_t)(MX25R_PAGE_SIZE - 1);
+    const uint32_t start = index->written > offset ? index->written : offset;
+    const uint32_t end = base + index->page_fill < offset + size ? base + index->page_fill : offset + size;
+
+    if(start < end)
+        memcpy(index->scan + (start - offset), index->page + (start - base), end - start);
+
+    return 1;
+
+}
+
+/**
+ * @brief Finds how many records the open sector holds after a mount and what their keys span
+ * @note A record that fails its CRC was torn by a power loss, it is stepped over and left in place since appending can't program over it,
+ *       queries skip it the same way
+ *
+ * @param[in] index: Log being mounted
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RIndexRecover(MX25RIndex* const index) {
+
+    const uint16_t per_scan = MX25R_INDEX_SCAN_SIZE / index->slot_size;
+
+    index->open_count = 0;
+    index->open_min = MX25R_INDEX_EMPTY_KEY;
+    index->open_max = 0;
+    index->written = 0;
+    index->page_fill = 0;
+    memset(index->page, 0xff, MX25R_PAGE_SIZE);
+
+    // nothing is staged yet, so loading only reads flash, the first erased slot is where appending left off
+    bool is_end = false;
+
+    for(uint16_t first = 0; first < index->records_per_sector && !is_end; first += per_scan) {
+
+        const uint16_t count = first + per_scan > index->records_per_sector ? index->records_per_sector - first : per_scan;
+        if(MX25RIndexLoad(index, index->open_sector, (uint32_t)first * index->slot_size, (uint32_t)count * index->slot_size) == 0)
+            return 0;
+
+        for(uint16_t i = 0; i < count && !is_end; i++) {
+
+            const uint8_t* const slot = index->scan + i * index->slot_size;
+            is_end = MX25RIndexIsBlank(index, slot);
+
+            if(is_end)
+                break;
+
+            index->open_count++;
+
+            if(MX25RIndexIsIntact(index, slot)) {
+                const uint32_t key = MX25RIndexKey(slot);
+                index->open_min = key < index->open_min ? key : index->open_min;
+                index->open_max = key > index->open_max ? key : index->open_max;
+            }
+
+        }
+
+    }
+
+    index->written = (uint32_t)index->open_count * index->slot_size;
+    index->page_fill = (uint16_t)(index->written % MX25R_PAGE_SIZE);
+
+    return 1;
+
+}
+
+/**
+ * @brief Sets up a log with nothing loaded from flash yet
+ *
+ * @param[out] index: Log to set up
+ * @param[in] dev: Device the log is on
+ * @param[in] first_sector: First sector of the region
+ * @param[in] sector_count: How many sectors the region has
+ * @param[in] record_size: Size of every record
+ * @return MX25RIndex*: NULL if the region or the record size is not valid and index if they are
+ */
+static MX25RIndex* MX25RIndexSetup(MX25RIndex* const index, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint16_t record_size) {
+
+    if(index == NULL || dev == NULL || record_size < sizeof(uint32_t) || record_size > MX25R_INDEX_SCAN_SIZE - 2)
+        return NULL;
+
+    if(sector_count < MX25R_INDEX_TABLE_SECTORS + 2 || sector_count - MX25R_INDEX_TABLE_SECTORS > MX25R_INDEX_MAX_SECTORS)
+        return NULL;
+
+    index->dev = dev;
+    index->first_sector = first_sector;
+    index->data_count = sector_count - MX25R_INDEX_TABLE_SECTORS;
+    index->record_size = record_size;
+    index->slot_size = record_size + 2;
+    index->records_per_sector = MX25R_SECTOR_SIZE / index->slot_size;
+    index->sequence = 0;
+    index->table = 0;
+    index->table_next = 0;
+
+    memset(index->summary, 0, sizeof(index->summary));
+
+    return index;
+
+}
+
+MX25RIndex* MX25RIndexMount(MX25RIndex* const index, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint16_t record_size) {
+
+    if(MX25RIndexSetup(index, dev, first_sector, sector_count, record_size) == NULL)
+        return NULL;
+
+    bool is_complete[MX25R_INDEX_TABLE_SECTORS] = { false, false };
+    uint32_t newest[MX25R_INDEX_TABLE_SECTORS] = { 0, 0 };
+    uint16_t used[MX25R_INDEX_TABLE_SECTORS] = { MX25R_INDEX_ENTRIES, MX25R_INDEX_ENTRIES };
+
+    for(uint8_t table = 0; table < MX25R_INDEX_TABLE_SECTORS; table++) {
+
+        for(uint16_t slot = 0; slot < MX25R_INDEX_ENTRIES; slot++) {
+
+            if(slot % (MX25R_INDEX_SCAN_SIZE / MX25R_INDEX_ENTRY_SIZE) == 0 && MX25RFastRead(dev, (uint32_t)(first_sector + table) * MX25R_SECTOR_SIZE + slot * MX25R_INDEX_ENTRY_SIZE, index->scan, MX25R_INDEX_SCAN_SIZE) == 0)
+                return NULL;
+
+            MX25RIndexEntry entry;
+            memcpy(&entry, index->scan + (slot * MX25R_INDEX_ENTRY_SIZE) % MX25R_INDEX_SCAN_SIZE, sizeof(entry));
+
+            // entries are appended in order, so the first erased slot is where the next one goes
+            if(entry.sequence == 0xffffffff) {
+                used[table] = slot;
+                break;
+            }
+
+            // a torn entry is skipped, what it was about is logged again
+            if(entry.crc != MX25RCrc16(MX25R_CRC16_INIT, &entry, offsetof(MX25RIndexEntry, crc)))
+                continue;
+
+            newest[table] = entry.sequence > newest[table] ? entry.sequence : newest[table];
+            index->sequence = entry.sequence > index->sequence ? entry.sequence : index->sequence;
+
+            const uint8_t kind = (uint8_t)(entry.sector >> MX25R_INDEX_KIND_SHIFT);
+            const uint16_t sector = entry.sector & MX25R_INDEX_SECTOR_MASK;
+
+            if(kind == MX25R_INDEX_TABLE)
+                is_complete[table] = true;
+            else if(sector < index->data_count && entry.sequence > index->summary[sector].sequence)
+                index->summary[sector] = (MX25RIndexSummary){ entry.sequence, entry.min_key, entry.max_key, kind };
+
+        }
+
+    }
+
+    // a table sector that was being compacted into when the power went is not trusted to hold everything
+    if(!is_complete[0] && !is_complete[1])
+        return NULL;
+
+    index->table = !is_complete[0] || (is_complete[1] && newest[1] > newest[0]);
+    index->table_next = used[index->table];
+
+    // the open sector is the newest one that was being opened, if there is none the one after the newest sealed sector is opened
+    uint16_t open = MX25R_INDEX_MAX_SECTORS, sealed = MX25R_INDEX_MAX_SECTORS;
+    uint32_t open_sequence = 0, sealed_sequence = 0;
+
+    for(uint16_t sector = 0; sector < index->data_count; sector++) {
+
+        const MX25RIndexSummary* const summary = index->summary + sector;
+
+        if(summary->kind == MX25R_INDEX_SEALED && summary->sequence > sealed_sequence) {
+            sealed = sector;
+            sealed_sequence = summary->sequence;
+        }
+        else if(summary->kind != MX25R_INDEX_SEALED && summary->sequence > open_sequence) {
+            open = sector;
+            open_sequence = summary->sequence;
+        }
+
+    }
+
+    if(open != MX25R_INDEX_MAX_SECTORS && open_sequence > sealed_sequence && index->summary[open].kind == MX25R_INDEX_OPEN) {
+        index->open_sector = open;
+        return MX25RIndexRecover(index) ? index : NULL;
+    }
+
+    // the erase may not have happened, so opening is done over
+    if(open == MX25R_INDEX_MAX_SECTORS || open_sequence < sealed_sequence)
+        open = sealed == MX25R_INDEX_MAX_SECTORS ? 0 : (sealed + 1) % index->data_count;
+
+    return MX25RIndexOpen(index, open) ? index : NULL;
+
+}
+
+uint8_t MX25RIndexFormat(MX25RIndex* const index, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint16_t record_size) {
+
+    if(MX25RIndexSetup(index, dev, first_sector, sector_count, record_size) == NULL)
+        return 0;
+
+    for(uint8_t table = 0; table < MX25R_INDEX_TABLE_SECTORS; table++)
+        if(MX25RIndexErase(index, table) == 0)
+            return 0;
+
+    MX25RIndexEntry entry;
+    MX25RIndexMakeEntry(&entry, ++index->sequence, MX25R_INDEX_TABLE, 0, 0, 0);
+    if(MX25RIndexProgramEntry(index, 0, index->table_next++, &entry) == 0)
+        return 0;
+
+    return MX25RIndexOpen(index, 0);
+
+}
+
+uint8_t MX25RIndexAppend(MX25RIndex* const index, const void* const record) {
+
+    #ifdef DEBUG
+    if(index == NULL || record == NULL)
+        return 0;
+    #endif
+
+    const uint8_t* const bytes = (const uint8_t*)record;
+    const uint32_t key = MX25RIndexKey(bytes);
+
+    if(key == MX25R_INDEX_EMPTY_KEY)
+        return 0;
+
+    // seal the full sector with its key range and move on to the next one, dropping the oldest records once the log wraps
+    if(index->open_count == index->records_per_sector) {
+
+        if(MX25RIndexProgram(index) == 0 || MX25RIndexLog(index, MX25R_INDEX_SEALED, index->open_sector, index->open_min, index->open_max) == 0)
+            return 0;
+
+        if(MX25RIndexOpen(index, (index->open_sector + 1) % index->data_count) == 0)
+            return 0;
+
+    }
+
+    const uint16_t crc = MX25RCrc16(MX25R_CRC16_INIT, bytes, index->record_size);
+    const uint8_t crc_bytes[] = { (uint8_t)crc, (uint8_t)(crc >> 8) };
+
+    if(MX25RIndexStage(index, bytes, index->record_size) == 0 || MX25RIndexStage(index, crc_bytes, sizeof(crc_bytes)) == 0)
+        return 0;
+
+    index->open_count++;
+    index->open_min = key < index->open_min ? key : index->open_min;
+    index->open_max = key > index->open_max ? key : index->open_max;
+
+    return 1;
+
+}
+
+uint8_t MX25RIndexSync(MX25RIndex* const index) {
+
+    #ifdef DEBUG
+    if(index == NULL)
+        return 0;
+    #endif
+
+    return MX25RIndexProgram(index);
+
+}
+
+uint32_t MX25RIndexQuery(MX25RIndex* const index, const uint32_t min_key, const uint32_t max_key, bool (*found)(void* const context, const uint8_t* const record), void* const context) {
+
+    #ifdef DEBUG
+    if(index == NULL || found == NULL)
+        return 0;
+    #endif
+
+    const uint16_t per_scan = MX25R_INDEX_SCAN_SIZE / index->slot_size;
+    uint8_t matches[MX25R_INDEX_SCAN_SIZE / sizeof(uint32_t) / 8];
+    uint32_t total = 0;
+
+    // the sector after the open one is the oldest, so going around from there finds records oldest first
+    for(uint16_t step = 1; step <= index->data_count; step++) {
+
+        const uint16_t sector = (index->open_sector + step) % index->data_count;
+        const MX25RIndexSummary* const summary = index->summary + sector;
+
+        uint16_t records;
+        uint32_t low, high;
+
+        if(sector == index->open_sector) {
+            records = index->open_count;
+            low = index->open_min;
+            high = index->open_max;
+        }
+        else if(summary->sequence != 0 && summary->kind == MX25R_INDEX_SEALED) {
+            records = index->records_per_sector;
+            low = summary->min_key;
+            high = summary->max_key;
+        }
+        else
+            continue;
+
+        // the summary rules out the whole sector without reading any of it
+        if(records == 0 || high < min_key || low > max_key)
+            continue;
+
+        for(uint16_t first = 0; first < records; first += per_scan) {
+
+            const uint16_t count = first + per_scan > records ? records - first : per_scan;
+            if(MX25RIndexLoad(index, sector, (uint32_t)first * index->slot_size, (uint32_t)count * index->slot_size) == 0)
+                return total;
+
+            if(MX25RIndexFilter(index->scan, count, index->slot_size, min_key, max_key, matches) == 0)
+                continue;
+
+            for(uint16_t i = 0; i < count; i++) {
+
+                // a record torn by a power loss stays where it is and is never returned
+                const uint8_t* const slot = index->scan + i * index->slot_size;
+                if(!(matches[i / 8] & (1 << (i % 8))) || !MX25RIndexIsIntact(index, slot))
+                    continue;
+
+                total++;
+                if(!found(context, slot))
+                    return total;
+
+            }
+
+        }
+
+    }
+
+    return total;
+
+}
@@ -0,0 +1,253 @@
+/**
+ * @file MX25RPool.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the MX25R Pre-Erased Sector Pool
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "../include/MX25RPool.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Checks if every byte of a sector reads back as erased
+ *
+ * @param[in] dev: Device the sector is on
+ * @param[in] sector: Sector to check
+ * @return true: If the sector is erased
+ * @return false: If anything in the sector was programmed or the read failed
+ */
+static bool MX25RPoolIsSectorBlank(const MX25R* const dev, const uint16_t sector) {
+
+    uint8_t page[MX25R_PAGE_SIZE];
+    const uint32_t address = (uint32_t)sector * MX25R_SECTOR_SIZE;
+
+    for(uint32_t offset = 0; offset < MX25R_SECTOR_SIZE; offset += MX25R_PAGE_SIZE) {
+
+        if(MX25RRead(dev, address + offset, page, MX25R_PAGE_SIZE) == 0)
+            return false;
+
+        for(uint16_t i = 0; i < MX25R_PAGE_SIZE; i++)
+            if(page[i] != 0xff)
+                return false;
+
+    }
+
+    return true;
+
+}
+
+/**
+ * @brief Puts an erased sector at the back of the ready ring
+ *
+ * @param[in] pool: Pool to add the sector to
+ * @param[in] sector: Sector that is erased
+ * @return uint8_t: Status, 0 if the ring was full
+ */
+static uint8_t MX25RPoolPushReady(MX25RPool* const pool, const uint16_t sector) {
+
+    if(pool->ready_count >= MX25R_POOL_CAPACITY)
+        return 0;
+
+    pool->ready[(pool->ready_head + pool->ready_count) % MX25R_POOL_CAPACITY] = sector;
+    pool->ready_count++;
+
+    return 1;
+
+}
+
+/**
+ * @brief Looks at the next sector in the region and adds it to the pool if it is already erased
+ *
+ * @param[in] pool: Pool to scan for
+ * @return uint8_t: Status, 0 if there was nothing left to scan
+ */
+static uint8_t MX25RPoolScanStep(MX25RPool* const pool) {
+
+    if(pool->scan_cursor >= pool->sector_count)
+        return 0;
+
+    const uint16_t index = pool->scan_cursor++;
+    const uint16_t sector = pool->first_sector + index;
+
+    // a sector released before the scan got to it is erased from the backlog, and may be handed out and still blank by now
+    for(uint8_t i = 0; i < pool->ahead_count; i++) {
+
+        if(pool->ahead[i] == sector) {
+
+            pool->ahead[i] = pool->ahead[--pool->ahead_count];
+            return 1;
+
+        }
+
+    }
+
+    bool is_erased;
+    if(pool->erased_map != NULL)
+        is_erased = pool->erased_map[index >> 3] & (1 << (index & 7));
+    else
+        is_erased = MX25RPoolIsSectorBlank(pool->dev, sector);
+
+    if(is_erased)
+        MX25RPoolPushReady(pool, sector);
+
+    return 1;
+
+}
+
+MX25RPool* MX25RPoolInit(MX25RPool* const pool, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint8_t target, const uint8_t* const erased_map) {
+
+    if(pool == NULL || dev == NULL || sector_count == 0 || target == 0 || target > MX25R_POOL_CAPACITY)
+        return NULL;
+
+    pool->dev = dev;
+    pool->erased_map = erased_map;
+    pool->first_sector = first_sector;
+    pool->sector_count = sector_count;
+    pool->scan_cursor = 0;
+    pool->target = target;
+
+    pool->ready_head = 0;
+    pool->ready_count = 0;
+    pool->backlog_head = 0;
+    pool->backlog_count = 0;
+    pool->ahead_count = 0;
+
+    pool->erasing = 0;
+    pool->is_erasing = false;
+    pool->is_suspended = false;
+
+    // only look as far as we need to fill the pool, the rest of the region is scanned while idle
+    while(pool->ready_count < pool->target && MX25RPoolScanStep(pool));
+
+    return pool;
+
+}
+
+uint8_t MX25RPoolAllocate(MX25RPool* const pool, uint16_t* const sector) {
+
+    #ifdef DEBUG
+    if(pool == NULL || sector == NULL)
+        return 0;
+    #endif
+
+    if(pool->ready_count == 0)
+        return 0;
+
+    *sector = pool->ready[pool->ready_head];
+    pool->ready_head = (pool->ready_head + 1) % MX25R_POOL_CAPACITY;
+    pool->ready_count--;
+
+    return 1;
+
+}
+
+uint8_t MX25RPoolRelease(MX25RPool* const pool, const uint16_t sector) {
+
+    #ifdef DEBUG
+    if(pool == NULL)
+        return 0;
+    #endif
+
+    if(sector < pool->first_sector || sector - pool->first_sector >= pool->sector_count)
+        return 0;
+
+    if(pool->backlog_count >= MX25R_POOL_BACKLOG)
+        return 0;
+
+    // the scan must not find this sector blank again once it is erased, or it would be handed out twice
+    if(sector - pool->first_sector >= pool->scan_cursor) {
+
+        if(pool->ahead_count >= MX25R_POOL_BACKLOG)
+            return 0;
+
+        pool->ahead[pool->ahead_count++] = sector;
+
+    }
+
+    pool->backlog[(pool->backlog_head + pool->backlog_count) % MX25R_POOL_BACKLOG] = sector;
+    pool->backlog_count++;
+
+    return 1;
+
+}
+
+uint8_t MX25RPoolService(MX25RPool* const pool) {
+
+    #ifdef DEBUG
+    if(pool == NULL)
+        return 0;
+    #endif
+
+    if(pool->is_suspended) {
+
+        pool->is_suspended = false;
+        return MX25RResume(pool->dev);
+
+    }
+
+    if(pool->is_erasing) {
+
+        if(MX25RIsWriteInProgress(pool->dev))
+            return 1;
+
+        pool->is_erasing = false;
+
+        // a sector that failed to erase is dropped rather than handed out
+        if(MX25RVerifyErase(pool->dev))
+            MX25RPoolPushReady(pool, pool->erasing);
+
+    }
+
+    if(pool->ready_count >= pool->target)
+        return 1;
+
+    if(pool->backlog_count == 0) {
+
+        MX25RPoolScanStep(pool);
+        return 1;
+
+    }
+
+    const uint16_t sector = pool->backlog[pool->backlog_head];
+
+    if(MX25REnableWriting(pool->dev) == 0 || MX25REraseSector(pool->dev, sector) == 0)
+        return 0;
+
+    pool->backlog_head = (pool->backlog_head + 1) % MX25R_POOL_BACKLOG;
+    pool->backlog_count--;
+
+    pool->erasing = sector;
+    pool->is_erasing = true;
+
+    return 1;
+
+}
+
+uint8_t MX25RPoolYield(MX25RPool* const pool) {
+
+    #ifdef DEBUG
+    if(pool == NULL)
+        return 0;
+    #endif
+
+    if(!pool->is_erasing || pool->is_suspended || !MX25RIsWriteInProgress(pool->dev))
+        return 1;
+
+    if(MX25RSuspend(pool->dev) == 0)
+        return 0;
+
+    // the suspend takes a few microseconds to land, after that the array is free for reads and programs
+    while(MX25RIsWriteInProgress(pool->dev));
+
+    pool->is_suspended = true;
+
+    return 1;
+
+}
+
+uint8_t MX25RPoolReadyCount(const MX25RPool* const pool) { return pool->ready_count; }
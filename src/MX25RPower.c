@@ -0,0 +1,261 @@
+/**
+ * @file MX25RPower.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the MX25R Power Governor
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "../include/MX25RPower.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Wakes the part with a CS pulse and waits out the recovery time
+ *
+ * @param[in] power: Governor of the sleeping part
+ */
+static void MX25RPowerWake(MX25RPower* const power) {
+
+    power->dev->hal.select_chip(true);
+    power->dev->hal.select_chip(false);
+
+    if(power->delay_us != NULL)
+        power->delay_us(MX25R_POWER_WAKE_US);
+
+    power->is_asleep = false;
+
+}
+
+/**
+ * @brief Waits for a configuration register write started earlier to land so the part takes commands again
+ *
+ * @param[in] power: Governor that started the write
+ */
+static void MX25RPowerSettle(MX25RPower* const power) {
+
+    while(MX25RIsWriteInProgress(power->dev));
+    power->is_mode_changing = false;
+
+}
+
+/**
+ * @brief Checks if a program or erase is suspended, the part has to stay awake and in its mode until it is resumed
+ *
+ * @param[in] power: Governor of the part
+ * @return true: If something is suspended or the security register could not be read
+ * @return false: If nothing is suspended
+ */
+static bool MX25RPowerIsSuspended(MX25RPower* const power) {
+
+    MX25RSecurityReg reg;
+    return MX25RReadSecurityReg(power->dev, &reg) == 0 || reg.erase_suspended || reg.program_suspended;
+
+}
+
+/**
+ * @brief Switches the part between ultra low power and high performance mode
+ *
+ * @param[in] power: Governor of the part
+ * @param[in] high_performance: If the part should run at full clock
+ * @param[in] can_wait: If we can wait on a running program or erase, otherwise the switch is skipped when the part is busy
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RPowerSetMode(MX25RPower* const power, const bool high_performance, const bool can_wait) {
+
+    if(power->is_asleep)
+        MX25RPowerWake(power);
+
+    // the configuration register can't be written while a program or erase is running or suspended
+    if(can_wait)
+        while(MX25RIsWriteInProgress(power->dev));
+    else if(MX25RIsWriteInProgress(power->dev))
+        return 1;
+
+    if(MX25RPowerIsSuspended(power))
+        return 1;
+
+    const bool was_write_en = power->dev->is_write_en;
+
+    uint8_t ret = MX25RSetLowPowerMode(power->dev, !high_performance);
+
+    if(ret) {
+        power->is_high_performance = high_performance;
+        power->is_mode_changing = true;
+    }
+
+    // writing the status register cleared write enable, it is sent again once the write landed, before the caller's next program, erase or register write
+    if(was_write_en && !power->dev->is_write_en)
+        power->is_restoring_write_en = true;
+
+    if(can_wait) {
+        MX25RPowerSettle(power);
+        if(MX25RPowerRestoreWriting(power) == 0)
+            ret = 0;
+    }
+
+    return ret;
+
+}
+
+MX25RPower* MX25RPowerInit(MX25RPower* const power, MX25R* const dev, uint32_t (*now_us)(void), void (*delay_us)(const uint32_t us)) {
+
+    if(power == NULL || dev == NULL || now_us == NULL)
+        return NULL;
+
+    power->dev = dev;
+    power->now_us = now_us;
+    power->delay_us = delay_us;
+
+    power->last_access_us = now_us();
+    power->average_gap_us = MX25R_POWER_MIN_IDLE_US / MX25R_POWER_IDLE_FACTOR;
+    power->pending = 0;
+
+    power->is_asleep = false;
+    power->is_high_performance = false;
+    power->is_mode_changing = false;
+    power->is_restoring_write_en = false;
+    power->is_governing = false;
+
+    dev->power = power;
+
+    return power;
+
+}
+
+void MX25RPowerDeinit(MX25RPower* const power) {
+
+    power->is_governing = true;
+
+    if(power->is_asleep)
+        MX25RPowerWake(power);
+
+    if(power->is_mode_changing)
+        MX25RPowerSettle(power);
+
+    // the driver won't ask for it once the governor is gone
+    MX25RPowerRestoreWriting(power);
+
+    power->dev->power = NULL;
+
+}
+
+uint8_t MX25RPowerQueue(MX25RPower* const power, const uint32_t count) {
+
+    #ifdef DEBUG
+    if(power == NULL)
+        return 0;
+    #endif
+
+    power->pending += count;
+
+    if(power->is_high_performance || power->pending < MX25R_POWER_BURST_PENDING)
+        return 1;
+
+    power->is_governing = true;
+    const uint8_t ret = MX25RPowerSetMode(power, true, true);
+    power->is_governing = false;
+
+    return ret;
+
+}
+
+void MX25RPowerComplete(MX25RPower* const power, const uint32_t count) { power->pending = count > power->pending ? 0 : power->pending - count; }
+
+uint8_t MX25RPowerService(MX25RPower* const power) {
+
+    #ifdef DEBUG
+    if(power == NULL)
+        return 0;
+    #endif
+
+    if(power->is_asleep)
+        return 1;
+
+    const uint32_t idle = power->now_us() - power->last_access_us;
+    const uint32_t timeout = MX25RPowerIdleTimeout(power);
+
+    uint8_t ret = 1;
+    power->is_governing = true;
+
+    // the write already landed, so this doesn't wait
+    if(power->is_mode_changing && !MX25RIsWriteInProgress(power->dev))
+        MX25RPowerSettle(power);
+
+    // drop the clock first, if nothing comes the part goes to sleep at the full timeout
+    if(power->is_high_performance && power->pending == 0 && idle >= timeout / 2)
+        ret = MX25RPowerSetMode(power, false, false);
+
+    // deep sleep is ignored while the part is busy, so only go down once it is done, and never with a program or erase suspended
+    else if(idle >= timeout && !power->is_mode_changing && !MX25RIsWriteInProgress(power->dev) && !MX25RPowerIsSuspended(power))
+        ret = MX25RDeepSleep(power->dev);
+
+    power->is_governing = false;
+
+    return ret;
+
+}
+
+uint8_t MX25RPowerRestoreWriting(MX25RPower* const power) {
+
+    if(!power->is_restoring_write_en)
+        return 1;
+
+    const bool was_governing = power->is_governing;
+    power->is_governing = true;
+
+    if(power->is_asleep)
+        MX25RPowerWake(power);
+
+    if(power->is_mode_changing)
+        MX25RPowerSettle(power);
+
+    const uint8_t ret = MX25REnableWriting(power->dev);
+
+    power->is_governing = was_governing;
+
+    return ret;
+
+}
+
+uint32_t MX25RPowerIdleTimeout(const MX25RPower* const power) {
+
+    const uint32_t timeout = power->average_gap_us * MX25R_POWER_IDLE_FACTOR;
+
+    if(timeout < MX25R_POWER_MIN_IDLE_US)
+        return MX25R_POWER_MIN_IDLE_US;
+
+    return timeout > MX25R_POWER_MAX_IDLE_US ? MX25R_POWER_MAX_IDLE_US : timeout;
+
+}
+
+void MX25RPowerOnCommand(MX25RPower* const power) {
+
+    if(power->is_governing)
+        return;
+
+    const uint32_t now = power->now_us();
+    uint32_t gap = now - power->last_access_us;
+    if(gap > MX25R_POWER_MAX_IDLE_US)
+        gap = MX25R_POWER_MAX_IDLE_US;
+
+    power->average_gap_us += (gap >> MX25R_POWER_AVERAGE_SHIFT) - (power->average_gap_us >> MX25R_POWER_AVERAGE_SHIFT);
+    power->last_access_us = now;
+
+    if(!power->is_asleep && !power->is_mode_changing)
+        return;
+
+    power->is_governing = true;
+
+    if(power->is_asleep)
+        MX25RPowerWake(power);
+
+    if(power->is_mode_changing)
+        MX25RPowerSettle(power);
+
+    power->is_governing = false;
+
+}
@@ -0,0 +1,446 @@
+/**
+ * @file MX25RTransaction.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of Atomic Multi-Page Transactions on the MX25R
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "../include/MX25RTransaction.h"
+#include "../include/MX25RCrc.h"
+
+#include <string.h>
+
+#define MX25R_TRANSACTION_MAGIC         0x4a54  ///< Marks the start of a commit record
+#define MX25R_TRANSACTION_HEADER_SIZE   8       ///< Magic, sequence number and page count at the start of a commit record
+
+#define MX25R_PAGES_PER_SECTOR          (MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE)
+#define MX25R_TRANSACTION_JOURNAL_PAGES (MX25R_TRANSACTION_JOURNAL_SECTORS * MX25R_PAGES_PER_SECTOR)
+
+/**
+ * @brief Gets how many bytes a commit record takes for a region
+ *
+ * @param[in] region: Region the record is for
+ * @return uint16_t: Header, map and CRC size
+ */
+static uint16_t MX25RTransactionRecordSize(const MX25RTransactionRegion* const region) { return MX25R_TRANSACTION_HEADER_SIZE + 2 * region->page_count + 2; }
+
+/**
+ * @brief Gets the absolute page number of a physical data page
+ *
+ * @param[in] region: Region the page is in
+ * @param[in] page: Data page relative to the first data sector
+ * @return uint16_t: The absolute page number
+ */
+static uint16_t MX25RTransactionDataPage(const MX25RTransactionRegion* const region, const uint16_t page) {
+
+    return (uint16_t)((region->first_sector + MX25R_TRANSACTION_JOURNAL_SECTORS) * MX25R_PAGES_PER_SECTOR + page);
+
+}
+
+/**
+ * @brief Programs one page and waits for it to land
+ *
+ * @param[in] dev: Device to program
+ * @param[in] page: Absolute page to program
+ * @param[in] data: Data to program
+ * @param[in] size: How many bytes to program
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RTransactionProgramPage(MX25R* const dev, const uint16_t page, const uint8_t* const data, const uint16_t size) {
+
+    if(MX25REnableWriting(dev) == 0 || MX25RPageProgram(dev, page, data, size) == 0)
+        return 0;
+
+    while(MX25RIsWriteInProgress(dev));
+
+    return MX25RVerifyProgram(dev);
+
+}
+
+/**
+ * @brief Erases one sector and waits for it to finish
+ *
+ * @param[in] dev: Device to erase
+ * @param[in] sector: Absolute sector to erase
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RTransactionEraseSector(MX25R* const dev, const uint16_t sector) {
+
+    if(MX25REnableWriting(dev) == 0 || MX25REraseSector(dev, sector) == 0)
+        return 0;
+
+    while(MX25RIsWriteInProgress(dev));
+
+    return MX25RVerifyErase(dev);
+
+}
+
+/**
+ * @brief Counts the pages of a data sector that the committed or the staged map still point to
+ *
+ * @param[in] region: Region the sector is in
+ * @param[in] sector: Data sector to check
+ * @return uint8_t: How many pages are live
+ */
+static uint8_t MX25RTransactionLivePages(const MX25RTransactionRegion* const region, const uint16_t sector) {
+
+    const uint16_t first = sector * MX25R_PAGES_PER_SECTOR;
+    uint8_t live = 0;
+
+    for(uint16_t i = 0; i < region->page_count; i++) {
+
+        // the committed copy has to survive until the commit that replaces it has landed
+        const bool is_committed = region->map[i] != MX25R_TRANSACTION_NO_PAGE && (uint16_t)(region->map[i] - first) < MX25R_PAGES_PER_SECTOR;
+        const bool is_staged = region->staged[i] != MX25R_TRANSACTION_NO_PAGE && (uint16_t)(region->staged[i] - first) < MX25R_PAGES_PER_SECTOR;
+
+        live += is_committed || is_staged;
+
+    }
+
+    return live;
+
+}
+
+/**
+ * @brief Counts how many shadow pages can be handed out without reclaiming anything
+ *
+ * @param[in] region: Region to check
+ * @return uint32_t: The number of free pages
+ */
+static uint32_t MX25RTransactionFreePages(const MX25RTransactionRegion* const region) {
+
+    uint32_t free_pages = region->open_sector != MX25R_TRANSACTION_NO_PAGE ? MX25R_PAGES_PER_SECTOR - region->open_next : 0;
+
+    for(uint16_t sector = 0; sector < region->data_sector_count; sector++)
+        if(sector != region->open_sector && MX25RTransactionLivePages(region, sector) == 0)
+            free_pages += MX25R_PAGES_PER_SECTOR;
+
+    return free_pages;
+
+}
+
+/**
+ * @brief Hands out a fresh erased shadow page, opening and erasing a dead sector when the open one is used up
+ *
+ * @param[in] region: Region to take the page from
+ * @param[out] page: The data page that was handed out
+ * @return uint8_t: Status, 0 if there was an error or there are no dead sectors left
+ */
+static uint8_t MX25RTransactionAllocate(MX25RTransactionRegion* const region, uint16_t* const page) {
+
+    if(region->open_sector == MX25R_TRANSACTION_NO_PAGE || region->open_next >= MX25R_PAGES_PER_SECTOR) {
+
+        uint16_t sector = 0;
+        while(sector < region->data_sector_count && (sector == region->open_sector || MX25RTransactionLivePages(region, sector) != 0))
+            sector++;
+
+        if(sector >= region->data_sector_count)
+            return 0;
+
+        // whatever an interrupted transaction left in a dead sector is wiped before it is reused
+        if(MX25RTransactionEraseSector(region->dev, region->first_sector + MX25R_TRANSACTION_JOURNAL_SECTORS + sector) == 0)
+            return 0;
+
+        region->open_sector = sector;
+        region->open_next = 0;
+
+    }
+
+    *page = region->open_sector * MX25R_PAGES_PER_SECTOR + region->open_next++;
+
+    return 1;
+
+}
+
+/**
+ * @brief Writes the staged map as the newest commit record and makes it the committed map
+ *
+ * @param[in] region: Region to commit
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RTransactionWriteRecord(MX25RTransactionRegion* const region) {
+
+    // records only ever land in a freshly erased journal sector, the sector we erase never holds the newest record
+    if(region->journal_page % MX25R_PAGES_PER_SECTOR == 0 && MX25RTransactionEraseSector(region->dev, region->first_sector + region->journal_page / MX25R_PAGES_PER_SECTOR) == 0)
+        return 0;
+
+    const uint32_t sequence = region->sequence + 1;
+    uint8_t* const record = region->page;
+
+    record[0] = (uint8_t)MX25R_TRANSACTION_MAGIC;
+    record[1] = (uint8_t)(MX25R_TRANSACTION_MAGIC >> 8);
+    record[2] = (uint8_t)sequence;
+    record[3] = (uint8_t)(sequence >> 8);
+    record[4] = (uint8_t)(sequence >> 16);
+    record[5] = (uint8_t)(sequence >> 24);
+    record[6] = (uint8_t)region->page_count;
+    record[7] = (uint8_t)(region->page_count >> 8);
+
+    for(uint16_t i = 0; i < region->page_count; i++) {
+        record[MX25R_TRANSACTION_HEADER_SIZE + 2 * i] = (uint8_t)region->staged[i];
+        record[MX25R_TRANSACTION_HEADER_SIZE + 2 * i + 1] = (uint8_t)(region->staged[i] >> 8);
+    }
+
+    const uint16_t size = MX25RTransactionRecordSize(region);
+    const uint16_t crc = MX25RCrc16(MX25R_CRC16_INIT, record, size - 2);
+    record[size - 2] = (uint8_t)crc;
+    record[size - 1] = (uint8_t)(crc >> 8);
+
+    const uint16_t journal_page = region->journal_page;
+    region->journal_page = (region->journal_page + 1) % MX25R_TRANSACTION_JOURNAL_PAGES;
+
+    if(MX25RTransactionProgramPage(region->dev, region->first_sector * MX25R_PAGES_PER_SECTOR + journal_page, record, size) == 0)
+        return 0;
+
+    memcpy(region->map, region->staged, sizeof(uint16_t) * region->page_count);
+    region->sequence = sequence;
+
+    return 1;
+
+}
+
+/**
+ * @brief Moves the live pages out of the data sector with the fewest of them and commits the move, so the sector can be reused
+ *
+ * @param[in] region: Region to reclaim space in, must not be in a transaction
+ * @return uint8_t: Status, 0 if there was an error or nothing could be gained
+ */
+static uint8_t MX25RTransactionReclaim(MX25RTransactionRegion* const region) {
+
+    uint16_t victim = MX25R_TRANSACTION_NO_PAGE;
+    uint8_t victim_live = MX25R_PAGES_PER_SECTOR;
+
+    for(uint16_t sector = 0; sector < region->data_sector_count; sector++) {
+
+        if(sector == region->open_sector)
+            continue;
+
+        const uint8_t live = MX25RTransactionLivePages(region, sector);
+        if(live != 0 && live < victim_live) {
+            victim = sector;
+            victim_live = live;
+        }
+
+    }
+
+    if(victim == MX25R_TRANSACTION_NO_PAGE)
+        return 0;
+
+    const uint16_t first = victim * MX25R_PAGES_PER_SECTOR;
+
+    for(uint16_t i = 0; i < region->page_count; i++) {
+
+        if(region->map[i] == MX25R_TRANSACTION_NO_PAGE || (uint16_t)(region->map[i] - first) >= MX25R_PAGES_PER_SECTOR)
+            continue;
+
+        uint16_t page;
+        if(MX25RTransactionAllocate(region, &page) == 0 ||
+           MX25RRead(region->dev, (uint32_t)MX25RTransactionDataPage(region, region->map[i]) * MX25R_PAGE_SIZE, region->page, MX25R_PAGE_SIZE) == 0 ||
+           MX25RTransactionProgramPage(region->dev, MX25RTransactionDataPage(region, page), region->page, MX25R_PAGE_SIZE) == 0) {
+
+            memcpy(region->staged, region->map, sizeof(uint16_t) * region->page_count);
+            return 0;
+
+        }
+
+        region->staged[i] = page;
+
+    }
+
+    if(MX25RTransactionWriteRecord(region) == 0) {
+
+        memcpy(region->staged, region->map, sizeof(uint16_t) * region->page_count);
+        return 0;
+
+    }
+
+    return 1;
+
+}
+
+MX25RTransactionRegion* MX25RTransactionMount(MX25RTransactionRegion* const region, MX25R* const dev, const uint16_t first_sector, const uint16_t sector_count, const uint16_t page_count) {
+
+    if(region == NULL || dev == NULL || page_count == 0 || page_count > MX25R_TRANSACTION_MAX_PAGES)
+        return NULL;
+
+    // every logical page plus a sector to move them through and a sector being reclaimed, anything less can wedge
+    const uint16_t min_data_sectors = (page_count + MX25R_PAGES_PER_SECTOR - 1) / MX25R_PAGES_PER_SECTOR + 2;
+    if(sector_count < MX25R_TRANSACTION_JOURNAL_SECTORS + min_data_sectors)
+        return NULL;
+
+    region->dev = dev;
+    region->first_sector = first_sector;
+    region->data_sector_count = sector_count - MX25R_TRANSACTION_JOURNAL_SECTORS;
+    region->page_count = page_count;
+    region->sequence = 0;
+    region->journal_page = 0;
+    region->open_sector = MX25R_TRANSACTION_NO_PAGE;
+    region->open_next = 0;
+    region->in_transaction = false;
+    region->is_dirty = false;
+
+    for(uint16_t i = 0; i < page_count; i++)
+        region->map[i] = MX25R_TRANSACTION_NO_PAGE;
+
+    const uint16_t size = MX25RTransactionRecordSize(region);
+    const uint32_t data_pages = (uint32_t)region->data_sector_count * MX25R_PAGES_PER_SECTOR;
+    bool is_found = false;
+    uint16_t newest_page = 0;
+
+    for(uint16_t journal_page = 0; journal_page < MX25R_TRANSACTION_JOURNAL_PAGES; journal_page++) {
+
+        uint8_t* const record = region->page;
+        if(MX25RRead(dev, ((uint32_t)first_sector * MX25R_PAGES_PER_SECTOR + journal_page) * MX25R_PAGE_SIZE, record, size) == 0)
+            return NULL;
+
+        const uint16_t magic = (uint16_t)(record[0] | (record[1] << 8));
+        const uint32_t sequence = (uint32_t)record[2] | ((uint32_t)record[3] << 8) | ((uint32_t)record[4] << 16) | ((uint32_t)record[5] << 24);
+        const uint16_t record_pages = (uint16_t)(record[6] | (record[7] << 8));
+        const uint16_t crc = (uint16_t)(record[size - 2] | (record[size - 1] << 8));
+
+        if(magic != MX25R_TRANSACTION_MAGIC || record_pages != page_count || crc != MX25RCrc16(MX25R_CRC16_INIT, record, size - 2))
+            continue;
+
+        if(is_found && sequence <= region->sequence)
+            continue;
+
+        bool is_valid = true;
+        for(uint16_t i = 0; i < page_count; i++) {
+
+            const uint16_t page = (uint16_t)(record[MX25R_TRANSACTION_HEADER_SIZE + 2 * i] | (record[MX25R_TRANSACTION_HEADER_SIZE + 2 * i + 1] << 8));
+            is_valid &= page == MX25R_TRANSACTION_NO_PAGE || page < data_pages;
+            region->staged[i] = page;
+
+        }
+
+        if(!is_valid)
+            continue;
+
+        memcpy(region->map, region->staged, sizeof(uint16_t) * page_count);
+        region->sequence = sequence;
+        newest_page = journal_page;
+        is_found = true;
+
+    }
+
+    memcpy(region->staged, region->map, sizeof(uint16_t) * page_count);
+
+    // the rest of the newest record's sector may hold a torn record, so the next one starts in a fresh sector
+    if(is_found)
+        region->journal_page = (newest_page / MX25R_PAGES_PER_SECTOR + 1) % MX25R_TRANSACTION_JOURNAL_SECTORS * MX25R_PAGES_PER_SECTOR;
+
+    return region;
+
+}
+
+uint8_t MX25RTransactionBegin(MX25RTransactionRegion* const region) {
+
+    #ifdef DEBUG
+    if(region == NULL)
+        return 0;
+    #endif
+
+    if(region->in_transaction)
+        return 0;
+
+    // make room for the transaction to rewrite every page once, as far as reclaiming can get us
+    while(MX25RTransactionFreePages(region) < region->page_count && MX25RTransactionReclaim(region));
+
+    region->in_transaction = true;
+    region->is_dirty = false;
+
+    return 1;
+
+}
+
+uint8_t MX25RTransactionWrite(MX25RTransactionRegion* const region, const uint16_t page, const uint8_t* const data, const uint16_t size) {
+
+    #ifdef DEBUG
+    if(region == NULL || data == NULL)
+        return 0;
+    #endif
+
+    if(!region->in_transaction || page >= region->page_count || size == 0 || size > MX25R_PAGE_SIZE)
+        return 0;
+
+    uint16_t shadow;
+    if(MX25RTransactionAllocate(region, &shadow) == 0)
+        return 0;
+
+    if(MX25RTransactionProgramPage(region->dev, MX25RTransactionDataPage(region, shadow), data, size) == 0)
+        return 0;
+
+    region->staged[page] = shadow;
+    region->is_dirty = true;
+
+    return 1;
+
+}
+
+uint8_t MX25RTransactionCommit(MX25RTransactionRegion* const region) {
+
+    #ifdef DEBUG
+    if(region == NULL)
+        return 0;
+    #endif
+
+    if(!region->in_transaction)
+        return 0;
+
+    if(region->is_dirty && MX25RTransactionWriteRecord(region) == 0)
+        return 0;
+
+    region->in_transaction = false;
+    region->is_dirty = false;
+
+    return 1;
+
+}
+
+void MX25RTransactionAbort(MX25RTransactionRegion* const region) {
+
+    memcpy(region->staged, region->map, sizeof(uint16_t) * region->page_count);
+
+    region->in_transaction = false;
+    region->is_dirty = false;
+
+}
+
+uint8_t MX25RTransactionRead(MX25RTransactionRegion* const region, const uint32_t address, uint8_t* const output, const uint32_t size) {
+
+    #ifdef DEBUG
+    if(region == NULL || output == NULL)
+        return 0;
+    #endif
+
+    const uint32_t logical_size = (uint32_t)region->page_count * MX25R_PAGE_SIZE;
+    if(address > logical_size || size > logical_size - address)
+        return 0;
+
+    uint32_t done = 0;
+    while(done < size) {
+
+        const uint32_t position = address + done;
+        const uint16_t page = (uint16_t)(position / MX25R_PAGE_SIZE);
+        const uint32_t offset = position % MX25R_PAGE_SIZE;
+        const uint32_t chunk = (size - done < MX25R_PAGE_SIZE - offset) ? size - done : MX25R_PAGE_SIZE - offset;
+
+        // outside a transaction staged is the committed map
+        const uint16_t physical = region->staged[page];
+
+        if(physical == MX25R_TRANSACTION_NO_PAGE)
+            memset(output + done, 0xff, chunk);
+        else if(MX25RRead(region->dev, (uint32_t)MX25RTransactionDataPage(region, physical) * MX25R_PAGE_SIZE + offset, output + done, chunk) == 0)
+            return 0;
+
+        done += chunk;
+
+    }
+
+    return 1;
+
+}
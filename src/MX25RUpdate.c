@@ -0,0 +1,411 @@
+/**
+ * @file MX25RUpdate.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the MX25R Delta Firmware Update Writer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "../include/MX25RUpdate.h"
+#include "../include/MX25RCrc.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define MX25R_UPDATE_CRC_START      offsetof(MX25RUpdateCheckpoint, delta_offset)                                       ///< First byte of a checkpoint the CRC covers
+#define MX25R_UPDATE_CRC_SIZE       (offsetof(MX25RUpdateCheckpoint, header) + MX25R_UPDATE_HEADER_SIZE - MX25R_UPDATE_CRC_START)  ///< How many bytes the CRC covers, stops before any trailing padding
+
+/**
+ * @brief Reads a little endian u32 out of an op header
+ *
+ * @param[in] in: Where the value starts
+ * @return uint32_t: The value
+ */
+static uint32_t MX25RUpdateGet32(const uint8_t* const in) { return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24); }
+
+/**
+ * @brief Runs the CRC over a checkpoint
+ *
+ * @param[in] checkpoint: Checkpoint to check
+ * @return uint16_t: The CRC it should have
+ */
+static uint16_t MX25RUpdateCrc(const MX25RUpdateCheckpoint* const checkpoint) { return MX25RCrc16(MX25R_CRC16_INIT, (const uint8_t*)checkpoint + MX25R_UPDATE_CRC_START, MX25R_UPDATE_CRC_SIZE); }
+
+/**
+ * @brief Starts erasing the next block of the target slot that has not been erased
+ *
+ * @param[in] update: Update to erase for
+ */
+static void MX25RUpdateStartErase(MX25RUpdate* const update) {
+
+    const MX25RBlock block = (MX25RBlock)(update->first_block + update->state.erased_blocks);
+
+    if(MX25REnableWriting(update->dev) == 0 || MX25REraseBlock(update->dev, block) == 0) {
+        update->has_failed = true;
+        return;
+    }
+
+    update->is_erasing = true;
+
+}
+
+/**
+ * @brief Checks a finished erase and counts the block as ready to program
+ *
+ * @param[in] update: Update that started the erase
+ */
+static void MX25RUpdateEndErase(MX25RUpdate* const update) {
+
+    update->is_erasing = false;
+
+    if(MX25RVerifyErase(update->dev))
+        update->state.erased_blocks++;
+    else
+        update->has_failed = true;
+
+}
+
+/**
+ * @brief Gets the bus back from a running erase before reading or programming, suspending it if it is not done yet
+ *
+ * @param[in] update: Update that wants the bus
+ */
+static void MX25RUpdatePause(MX25RUpdate* const update) {
+
+    if(!update->is_erasing || update->is_suspended)
+        return;
+
+    if(MX25RIsWriteInProgress(update->dev)) {
+
+        MX25RSuspend(update->dev);
+        while(MX25RIsWriteInProgress(update->dev));
+
+        MX25RSecurityReg reg;
+        MX25RReadSecurityReg(update->dev, &reg);
+
+        if(reg.erase_suspended) {
+            update->is_suspended = true;
+            return;
+        }
+
+    }
+
+    // the erase is done, maybe right before the suspend landed
+    MX25RUpdateEndErase(update);
+
+}
+
+/**
+ * @brief Gives the bus back to the erase, or starts erasing the block after the one being programmed
+ *
+ * @param[in] update: Update done with the bus
+ */
+static void MX25RUpdateRelease(MX25RUpdate* const update) {
+
+    if(update->is_suspended) {
+
+        update->is_suspended = false;
+        if(MX25RResume(update->dev) == 0)
+            update->has_failed = true;
+
+        return;
+
+    }
+
+    // stay one block ahead of programming, any further and a resume would have to redo more erases
+    if(!update->is_erasing && !update->has_failed && update->state.erased_blocks < update->block_count && update->state.erased_blocks <= update->state.written / MX25R_BLOCK_SIZE + 1)
+        MX25RUpdateStartErase(update);
+
+}
+
+/**
+ * @brief Makes sure a block of the target slot is erased, waiting on or running its erase if it is not
+ *
+ * @param[in] update: Update to program
+ * @param[in] block: Block of the target slot, relative to its start
+ */
+static void MX25RUpdateNeedBlock(MX25RUpdate* const update, const uint16_t block) {
+
+    while(block >= update->state.erased_blocks && !update->has_failed) {
+
+        if(!update->is_erasing) {
+            MX25RUpdateStartErase(update);
+            continue;
+        }
+
+        if(update->is_suspended) {
+            update->is_suspended = false;
+            MX25RResume(update->dev);
+        }
+
+        while(MX25RIsWriteInProgress(update->dev));
+        MX25RUpdateEndErase(update);
+
+    }
+
+}
+
+/**
+ * @brief Programs the staging page into the target slot, a partial page leaves the rest of the page to be programmed later
+ *
+ * @param[in] update: Update to program
+ */
+static void MX25RUpdateProgram(MX25RUpdate* const update) {
+
+    const uint32_t base = update->state.written & ~(uint32_t)(MX25R_PAGE_SIZE - 1);
+
+    if(update->has_failed || base + update->page_fill == update->state.written)
+        return;
+
+    MX25RUpdateNeedBlock(update, (uint16_t)(base / MX25R_BLOCK_SIZE));
+    if(update->has_failed)
+        return;
+
+    // the bytes programmed before are 0xff in the staging page, programming them again leaves them as they are
+    const MX25RPage page = (MX25RPage)(((uint32_t)update->first_block * MX25R_BLOCK_SIZE + base) / MX25R_PAGE_SIZE);
+
+    if(MX25REnableWriting(update->dev) == 0 || MX25RPageProgram(update->dev, page, update->page, update->page_fill) == 0) {
+        update->has_failed = true;
+        return;
+    }
+
+    while(MX25RIsWriteInProgress(update->dev));
+
+    if(!MX25RVerifyProgram(update->dev)) {
+        update->has_failed = true;
+        return;
+    }
+
+    update->state.written = base + update->page_fill;
+
+    if(update->page_fill == MX25R_PAGE_SIZE)
+        update->page_fill = 0;
+
+    memset(update->page, 0xff, update->page_fill ? update->page_fill : MX25R_PAGE_SIZE);
+
+}
+
+/**
+ * @brief Starts the op whose header was just taken in
+ *
+ * @param[in] update: Update to apply to
+ */
+static void MX25RUpdateStartOp(MX25RUpdate* const update) {
+
+    MX25RUpdateCheckpoint* const state = &update->state;
+
+    state->op = state->header[0];
+    state->op_remaining = MX25RUpdateGet32(state->header + 1);
+    state->op_source = state->op == MX25R_UPDATE_COPY ? MX25RUpdateGet32(state->header + 5) : 0;
+    state->header_size = 0;
+
+    const uint32_t taken = (state->written & ~(uint32_t)(MX25R_PAGE_SIZE - 1)) + update->page_fill;
+    const uint32_t capacity = (uint32_t)update->block_count * MX25R_BLOCK_SIZE;
+
+    if(state->op_remaining > capacity - taken)
+        update->has_failed = true;
+
+    if(state->op == MX25R_UPDATE_COPY && (state->op_source > update->source_size || state->op_remaining > update->source_size - state->op_source))
+        update->has_failed = true;
+
+}
+
+/**
+ * @brief Sets up an update with nothing applied and nothing erased yet
+ *
+ * @param[out] update: Update to set up
+ * @param[in] dev: Device the slots are on
+ * @param[in] source: Address of the current slot
+ * @param[in] source_size: How many bytes of the current slot copies may read
+ * @param[in] first_block: First 64KB block of the target slot
+ * @param[in] block_count: How many blocks the target slot has
+ * @return MX25RUpdate*: NULL if the slots are not valid and update if they are
+ */
+static MX25RUpdate* MX25RUpdateSetup(MX25RUpdate* const update, MX25R* const dev, const uint32_t source, const uint32_t source_size, const MX25RBlock first_block, const uint16_t block_count) {
+
+    if(update == NULL || dev == NULL || block_count == 0)
+        return NULL;
+
+    // the slots can't overlap or copies would read what was just programmed
+    const uint32_t target = (uint32_t)first_block * MX25R_BLOCK_SIZE;
+    if(source < target + (uint32_t)block_count * MX25R_BLOCK_SIZE && target < source + source_size)
+        return NULL;
+
+    update->dev = dev;
+    update->source = source;
+    update->source_size = source_size;
+    update->first_block = first_block;
+    update->block_count = block_count;
+
+    memset(&update->state, 0, sizeof(update->state));
+    update->state.magic = MX25R_UPDATE_MAGIC;
+
+    update->is_erasing = false;
+    update->is_suspended = false;
+    update->has_failed = false;
+
+    update->page_fill = 0;
+    memset(update->page, 0xff, MX25R_PAGE_SIZE);
+
+    return update;
+
+}
+
+MX25RUpdate* MX25RUpdateBegin(MX25RUpdate* const update, MX25R* const dev, const uint32_t source, const uint32_t source_size, const MX25RBlock first_block, const uint16_t block_count) {
+
+    if(MX25RUpdateSetup(update, dev, source, source_size, first_block, block_count) == NULL)
+        return NULL;
+
+    MX25RUpdateStartErase(update);
+
+    return update->has_failed ? NULL : update;
+
+}
+
+MX25RUpdate* MX25RUpdateResume(MX25RUpdate* const update, MX25R* const dev, const uint32_t source, const uint32_t source_size, const MX25RBlock first_block, const uint16_t block_count, const MX25RUpdateCheckpoint* const checkpoint) {
+
+    if(checkpoint == NULL || checkpoint->magic != MX25R_UPDATE_MAGIC || checkpoint->crc != MX25RUpdateCrc(checkpoint))
+        return NULL;
+
+    if(checkpoint->erased_blocks > block_count || checkpoint->written > (uint32_t)block_count * MX25R_BLOCK_SIZE)
+        return NULL;
+
+    if(MX25RUpdateSetup(update, dev, source, source_size, first_block, block_count) == NULL)
+        return NULL;
+
+    update->state = *checkpoint;
+    update->page_fill = (uint16_t)(checkpoint->written % MX25R_PAGE_SIZE);
+
+    // an erase cut off by the power loss was never counted, so it just starts again
+    MX25RUpdateRelease(update);
+
+    return update->has_failed ? NULL : update;
+
+}
+
+uint8_t MX25RUpdateWrite(MX25RUpdate* const update, const uint8_t* const delta, const uint32_t size) {
+
+    #ifdef DEBUG
+    if(update == NULL || (delta == NULL && size != 0))
+        return 0;
+    #endif
+
+    MX25RUpdateCheckpoint* const state = &update->state;
+    uint32_t taken = 0;
+
+    MX25RUpdatePause(update);
+
+    // a copy needs no more delta to run, so keep going after the input runs out until it is done
+    while((taken < size || state->op == MX25R_UPDATE_COPY) && !update->has_failed) {
+
+        if(state->op == 0) {
+
+            state->header[state->header_size++] = delta[taken++];
+
+            const uint8_t header_size = state->header[0] == MX25R_UPDATE_COPY ? 9 : state->header[0] == MX25R_UPDATE_INSERT ? 5 : 0;
+            if(header_size == 0) {
+                update->has_failed = true;
+                break;
+            }
+
+            if(state->header_size < header_size)
+                continue;
+
+            MX25RUpdateStartOp(update);
+            if(update->has_failed)
+                break;
+
+        }
+
+        uint32_t count = MX25R_PAGE_SIZE - update->page_fill;
+        if(count > state->op_remaining)
+            count = state->op_remaining;
+
+        if(state->op == MX25R_UPDATE_INSERT) {
+
+            if(count > size - taken)
+                count = size - taken;
+
+            memcpy(update->page + update->page_fill, delta + taken, count);
+            taken += count;
+
+        }
+        else if(count != 0 && MX25RFastRead(update->dev, update->source + state->op_source, update->page + update->page_fill, count) == 0)
+            update->has_failed = true;
+
+        state->op_source += state->op == MX25R_UPDATE_COPY ? count : 0;
+        state->op_remaining -= count;
+        update->page_fill += (uint16_t)count;
+
+        if(state->op_remaining == 0)
+            state->op = 0;
+
+        if(update->page_fill == MX25R_PAGE_SIZE)
+            MX25RUpdateProgram(update);
+
+    }
+
+    state->delta_offset += taken;
+
+    MX25RUpdateRelease(update);
+
+    return !update->has_failed;
+
+}
+
+uint8_t MX25RUpdateTakeCheckpoint(MX25RUpdate* const update, MX25RUpdateCheckpoint* const checkpoint) {
+
+    #ifdef DEBUG
+    if(update == NULL || checkpoint == NULL)
+        return 0;
+    #endif
+
+    if(update->has_failed)
+        return 0;
+
+    MX25RUpdatePause(update);
+    MX25RUpdateProgram(update);
+    MX25RUpdateRelease(update);
+
+    update->state.crc = MX25RUpdateCrc(&update->state);
+    *checkpoint = update->state;
+
+    return !update->has_failed;
+
+}
+
+uint8_t MX25RUpdateFinish(MX25RUpdate* const update, uint32_t* const size) {
+
+    #ifdef DEBUG
+    if(update == NULL)
+        return 0;
+    #endif
+
+    if(update->state.op != 0 || update->state.header_size != 0)
+        update->has_failed = true;
+
+    MX25RUpdatePause(update);
+    MX25RUpdateProgram(update);
+
+    // leave the part idle, the erase ahead is of no use any more
+    if(update->is_erasing) {
+
+        if(update->is_suspended) {
+            update->is_suspended = false;
+            MX25RResume(update->dev);
+        }
+
+        while(MX25RIsWriteInProgress(update->dev));
+        MX25RUpdateEndErase(update);
+
+    }
+
+    if(size != NULL)
+        *size = update->state.written;
+
+    return !update->has_failed;
+
+}
@@ -0,0 +1,209 @@
+/**
+ * @file MX25RCompressTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that a compressed region reclaims space as frames are rewritten and survives a power loss at any point
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+#include "MX25RCompress.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MX25R_COMPRESS_TEST_FIRST   32      ///< First sector of the region
+#define MX25R_COMPRESS_TEST_COUNT   6       ///< How many sectors the region has
+#define MX25R_COMPRESS_TEST_FRAMES  8       ///< How many frames the region holds
+#define MX25R_COMPRESS_TEST_ADDRESS ((uint32_t)MX25R_COMPRESS_TEST_FIRST * MX25R_SECTOR_SIZE)  ///< Where the region starts
+
+static uint8_t model[MX25R_COMPRESS_TEST_FRAMES][MX25R_COMPRESS_FRAME_SIZE];   ///< What every frame should read back as
+static uint8_t pending[MX25R_COMPRESS_FRAME_SIZE];                             ///< Contents of the frame being written when the power went
+static uint16_t pending_frame = MX25R_COMPRESS_NO_FRAME;                        ///< Which frame was being written, MX25R_COMPRESS_NO_FRAME if none
+static uint8_t snapshot[MX25R_COMPRESS_TEST_COUNT * MX25R_SECTOR_SIZE];        ///< The region as it was before the power cut sweep
+static uint8_t snapshot_model[MX25R_COMPRESS_TEST_FRAMES][MX25R_COMPRESS_FRAME_SIZE];  ///< The model as it was before the power cut sweep
+
+/**
+ * @brief Fills a frame with data, half the time random so it does not compress and half the time runs so it does
+ *
+ * @param[out] data: Where to put the frame, padded to a full frame with 0xff as it reads back
+ * @return uint16_t: How many bytes were written to the frame
+ */
+static uint16_t MX25RCompressTestFill(uint8_t* const data) {
+
+    const uint16_t size = (uint16_t)(1 + rand() % MX25R_COMPRESS_FRAME_SIZE);
+    const bool is_random = rand() % 2;
+
+    for(uint16_t i = 0; i < size; i++)
+        data[i] = (uint8_t)(is_random ? rand() : i / 32);
+
+    memset(data + size, 0xff, MX25R_COMPRESS_FRAME_SIZE - size);
+
+    return size;
+
+}
+
+/**
+ * @brief Writes a frame with new contents and updates the model once the write returned
+ *
+ * @param[in] region: Region to write to
+ * @param[in] frame: Frame to write
+ */
+static void MX25RCompressTestWrite(MX25RCompressRegion* const region, const uint16_t frame) {
+
+    const uint16_t size = MX25RCompressTestFill(pending);
+    pending_frame = frame;
+
+    MX25R_TEST_CHECK(MX25RCompressWriteFrame(region, frame, pending, size));
+
+    memcpy(model[frame], pending, MX25R_COMPRESS_FRAME_SIZE);
+    pending_frame = MX25R_COMPRESS_NO_FRAME;
+
+}
+
+/**
+ * @brief Mounts the region and checks every frame reads back as the model has it, or as the pending contents for the frame cut mid write
+ *
+ * @param[in] dev: Device the region is on
+ * @param[out] region: Region to mount
+ * @param[in] index: Storage for the frame index
+ */
+static void MX25RCompressTestCheck(MX25R* const dev, MX25RCompressRegion* const region, uint16_t* const index) {
+
+    static uint8_t frame_data[MX25R_COMPRESS_FRAME_SIZE];
+
+    MX25R_TEST_CHECK(MX25RCompressMount(region, dev, MX25R_COMPRESS_TEST_FIRST, MX25R_COMPRESS_TEST_COUNT, index, MX25R_COMPRESS_TEST_FRAMES) != NULL);
+
+    for(uint16_t frame = 0; frame < MX25R_COMPRESS_TEST_FRAMES; frame++) {
+
+        MX25R_TEST_CHECK(MX25RCompressRead(region, (uint32_t)frame * MX25R_COMPRESS_FRAME_SIZE, frame_data, MX25R_COMPRESS_FRAME_SIZE));
+
+        const bool is_old = memcmp(frame_data, model[frame], MX25R_COMPRESS_FRAME_SIZE) == 0;
+        const bool is_new = frame == pending_frame && memcmp(frame_data, pending, MX25R_COMPRESS_FRAME_SIZE) == 0;
+        MX25R_TEST_CHECK(is_old || is_new);
+
+        // whichever copy won is what the frame is now
+        if(is_new)
+            memcpy(model[frame], pending, MX25R_COMPRESS_FRAME_SIZE);
+
+    }
+
+    pending_frame = MX25R_COMPRESS_NO_FRAME;
+
+}
+
+/**
+ * @brief Rewrites random frames enough times to send the ring round several times, so every write after the first few needs a reclaim
+ *
+ * @param[in] region: Region to write to
+ * @param[in] writes: How many frames to write
+ */
+static void MX25RCompressTestWorkload(MX25RCompressRegion* const region, const uint32_t writes) {
+
+    for(uint32_t i = 0; i < writes; i++)
+        MX25RCompressTestWrite(region, (uint16_t)(rand() % MX25R_COMPRESS_TEST_FRAMES));
+
+}
+
+/// @brief What the power cut sweep works on
+typedef struct MX25RCOMPRESSTESTSTATE {
+
+    MX25R* dev;                     ///< Device the region is on
+    MX25RCompressRegion* region;    ///< Region under test
+    uint16_t* index;                ///< Storage for the frame index
+
+} MX25RCompressTestState;
+
+/**
+ * @brief Sweep setup, a fresh part holding the region and the model as they were before the sweep
+ *
+ * @param[in] context: The MX25RCompressTestState
+ */
+static void MX25RCompressTestSetup(void* const context) {
+
+    MX25RCompressTestState* const state = (MX25RCompressTestState*)context;
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    memcpy(MX25REmulatorGetMemory() + MX25R_COMPRESS_TEST_ADDRESS, snapshot, sizeof(snapshot));
+    memcpy(model, snapshot_model, sizeof(model));
+
+    MX25RTestInit(state->dev);
+    MX25RCompressMount(state->region, state->dev, MX25R_COMPRESS_TEST_FIRST, MX25R_COMPRESS_TEST_COUNT, state->index, MX25R_COMPRESS_TEST_FRAMES);
+
+    srand(2);
+
+}
+
+/**
+ * @brief Sweep workload, the same run of rewrites that was counted without a cut
+ *
+ * @param[in] context: The MX25RCompressTestState
+ */
+static void MX25RCompressTestWorkloadCut(void* const context) { MX25RCompressTestWorkload(((MX25RCompressTestState*)context)->region, 24); }
+
+/**
+ * @brief Sweep check, back up after the power loss the region has to mount, read and keep taking writes
+ *
+ * @param[in] context: The MX25RCompressTestState
+ */
+static void MX25RCompressTestCheckCut(void* const context) {
+
+    MX25RCompressTestState* const state = (MX25RCompressTestState*)context;
+
+    MX25RTestInit(state->dev);
+    MX25RCompressTestCheck(state->dev, state->region, state->index);
+
+    srand(3);
+    MX25RCompressTestWorkload(state->region, 6);
+    MX25RCompressTestCheck(state->dev, state->region, state->index);
+
+}
+
+int main(void) {
+
+    static MX25RCompressRegion region;
+    static uint16_t index[MX25R_COMPRESS_TEST_FRAMES];
+    MX25R dev;
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+    memset(model, 0xff, sizeof(model));
+
+    // a region three times over in rewrites, remounting along the way, has to keep every frame and its free space
+    srand(1);
+    MX25R_TEST_CHECK(MX25RCompressMount(&region, &dev, MX25R_COMPRESS_TEST_FIRST, MX25R_COMPRESS_TEST_COUNT, index, MX25R_COMPRESS_TEST_FRAMES) != NULL);
+    MX25R_TEST_CHECK(MX25RCompressFormat(&region));
+
+    for(uint32_t round = 0; round < 20; round++) {
+
+        MX25RCompressTestWorkload(&region, 15);
+
+        const uint32_t free_pages = MX25RCompressFreePages(&region);
+        MX25RCompressTestCheck(&dev, &region, index);
+        MX25R_TEST_CHECK(MX25RCompressFreePages(&region) == free_pages);
+
+    }
+
+    // a power cut anywhere in a run of rewrites leaves each frame as it was or, for the one being written, as it was going to be
+    memcpy(snapshot, MX25REmulatorGetMemory() + MX25R_COMPRESS_TEST_ADDRESS, sizeof(snapshot));
+    memcpy(snapshot_model, model, sizeof(model));
+
+    const uint32_t before = MX25REmulatorGetOperationCount();
+    srand(2);
+    MX25RCompressTestWorkload(&region, 24);
+    const uint32_t operations = MX25REmulatorGetOperationCount() - before;
+
+    MX25RCompressTestState state = { &dev, &region, index };
+    const MX25RTestSweep sweep = { MX25RCompressTestSetup, MX25RCompressTestWorkloadCut, MX25RCompressTestCheckCut, &state };
+    const uint8_t percents[] = { 0, 50, 100 };
+
+    MX25RTestSweepCuts(&sweep, operations, percents, sizeof(percents));
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("compress");
+
+}
@@ -0,0 +1,105 @@
+/**
+ * @file MX25REmulatorTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that the emulated part cuts power the way the recovery tests expect
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+
+#include <string.h>
+
+int main(void) {
+
+    MX25R dev;
+    uint8_t page[MX25R_PAGE_SIZE];
+    memset(page, 0x00, sizeof(page));
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+
+    uint8_t* const memory = MX25REmulatorGetMemory();
+
+    // a program cut halfway lands on the first half of the page only
+    MX25REmulatorSchedulePowerCut(0, 50, MX25RTestCut);
+
+    if(setjmp(mx25r_test_cut_point) == 0) {
+
+        MX25REnableWriting(&dev);
+        MX25RPageProgram(&dev, 0, page, MX25R_PAGE_SIZE);
+        MX25R_TEST_CHECK(!"the program should have been cut");
+
+    }
+
+    MX25R_TEST_CHECK(memory[0] == 0x00 && memory[MX25R_PAGE_SIZE / 2 - 1] == 0x00);
+    MX25R_TEST_CHECK(memory[MX25R_PAGE_SIZE / 2] == 0xff && memory[MX25R_PAGE_SIZE - 1] == 0xff);
+
+    // the part comes back idle with write enable cleared
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+
+    MX25RStatus status;
+    MX25R_TEST_CHECK(MX25RReadStatus(&dev, &status));
+    MX25R_TEST_CHECK(!status.write_in_progress && !status.write_enabled);
+
+    // operations before the cut run in full and a cut erase leaves the rest of the sector as it was
+    MX25REnableWriting(&dev);
+    MX25RPageProgram(&dev, MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE - 1, page, MX25R_PAGE_SIZE);
+    while(MX25RIsWriteInProgress(&dev));
+
+    const uint32_t before = MX25REmulatorGetOperationCount();
+    MX25REmulatorSchedulePowerCut(1, 25, MX25RTestCut);
+
+    if(setjmp(mx25r_test_cut_point) == 0) {
+
+        MX25REnableWriting(&dev);
+        MX25RPageProgram(&dev, 1, page, MX25R_PAGE_SIZE);
+        while(MX25RIsWriteInProgress(&dev));
+
+        MX25REnableWriting(&dev);
+        MX25REraseSector(&dev, 0);
+        MX25R_TEST_CHECK(!"the erase should have been cut");
+
+    }
+
+    MX25R_TEST_CHECK(MX25REmulatorGetOperationCount() == before + 2);
+    MX25R_TEST_CHECK(memory[0] == 0xff && memory[MX25R_PAGE_SIZE] == 0xff);
+    MX25R_TEST_CHECK(memory[MX25R_SECTOR_SIZE - 1] == 0x00);
+
+    // a cancelled cut never happens
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+    MX25REmulatorSchedulePowerCut(0, 0, MX25RTestCut);
+    MX25REmulatorCancelPowerCut();
+
+    MX25REnableWriting(&dev);
+    MX25R_TEST_CHECK(MX25REraseSector(&dev, 0));
+    while(MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RVerifyErase(&dev) && memory[MX25R_SECTOR_SIZE - 1] == 0xff);
+
+    // a plain read clocked past fR is not seen by the part, a fast read at the same clock still works
+    uint8_t out[4];
+    memory[0] = 0x12;
+    MX25REmulatorGetTiming()->spi_hz = MX25REmulatorGetTiming()->max_hz;
+
+    MX25R_TEST_CHECK(MX25RRead(&dev, 0, out, sizeof(out)) && out[0] == 0xff);
+    MX25R_TEST_CHECK(MX25RFastRead(&dev, 0, out, sizeof(out)) && out[0] == 0x12);
+
+    MX25REmulatorGetTiming()->spi_hz = MX25REmulatorGetTiming()->read_max_hz;
+    MX25R_TEST_CHECK(MX25RRead(&dev, 0, out, sizeof(out)) && out[0] == 0x12);
+
+    #ifdef DEBUG
+    // the sector past the end is turned away, on the smallest part it used to wrap round and erase sector 0
+    memory[0] = 0x00;
+    MX25REnableWriting(&dev);
+    MX25R_TEST_CHECK(MX25REraseSector(&dev, (MX25RSector)(MX25R_TEST_CAPACITY / MX25R_SECTOR_SIZE)) == 0);
+    MX25R_TEST_CHECK(!MX25RIsWriteInProgress(&dev) && memory[0] == 0x00);
+    #endif
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("emulator");
+
+}
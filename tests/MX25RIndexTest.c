@@ -0,0 +1,350 @@
+/**
+ * @file MX25RIndexTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that a record log never returns a record torn by a power loss and keeps every synced one
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+#include "MX25RIndex.h"
+
+#include <string.h>
+
+#define MX25R_INDEX_TEST_FIRST      64      ///< First sector of the region
+#define MX25R_INDEX_TEST_COUNT      6       ///< How many sectors the region has, the table and four data sectors
+#define MX25R_INDEX_TEST_RECORD     38      ///< Size of a record, records straddle pages
+#define MX25R_INDEX_TEST_SYNC       9       ///< How many records go by between syncs
+#define MX25R_INDEX_TEST_ENTRIES    (MX25R_SECTOR_SIZE / 16)    ///< How many 16 byte entries a summary table sector holds
+#define MX25R_INDEX_TEST_ADDRESS    ((uint32_t)MX25R_INDEX_TEST_FIRST * MX25R_SECTOR_SIZE)  ///< Where the region starts
+#define MX25R_INDEX_TEST_SLOT       (MX25R_INDEX_TEST_RECORD + 2)                   ///< Size of a record on flash with its CRC16
+#define MX25R_INDEX_TEST_PER_SECTOR (MX25R_SECTOR_SIZE / MX25R_INDEX_TEST_SLOT)     ///< How many records a data sector holds
+#define MX25R_INDEX_TEST_BASE_KEY   (0x80000000u - 150)     ///< First key of the range queries, the second sector holds keys either side of the sign bit
+#define MX25R_INDEX_TEST_RANGED     250                     ///< How many records the range queries run over, two sealed sectors and part of the open one
+
+static uint32_t next_key;       ///< Key of the next record to append, records are numbered in order
+static uint32_t synced_key;     ///< Key of the newest record that was synced, a power loss can't take it away
+static bool has_synced;         ///< If any record was synced yet
+
+static uint8_t snapshot[MX25R_INDEX_TEST_COUNT * MX25R_SECTOR_SIZE];   ///< The region as it was before the power cut sweep
+static uint32_t snapshot_key;       ///< next_key before the power cut sweep
+static uint32_t snapshot_synced;    ///< synced_key before the power cut sweep
+
+/// @brief What a query saw
+typedef struct MX25RINDEXTESTRESULT {
+
+    uint32_t count;             ///< How many records came back
+    uint32_t last_key;          ///< Key of the last record that came back
+    uint32_t window_count;      ///< How many of the records that must have survived came back
+
+} MX25RIndexTestResult;
+
+/**
+ * @brief Builds the record for a key, the body follows from the key so a torn one shows
+ *
+ * @param[out] record: Where to build it
+ * @param[in] key: Its key
+ */
+static void MX25RIndexTestMake(uint8_t* const record, const uint32_t key) {
+
+    memcpy(record, &key, sizeof(key));
+
+    for(uint16_t i = sizeof(key); i < MX25R_INDEX_TEST_RECORD; i++)
+        record[i] = (uint8_t)(key * 31 + i);
+
+}
+
+/**
+ * @brief Query callback, checks every record is whole, comes back in order and counts the ones that must have survived
+ *
+ * @param[in] context: The MX25RIndexTestResult
+ * @param[in] record: Record found
+ * @return true: Always, to see every record
+ */
+static bool MX25RIndexTestFound(void* const context, const uint8_t* const record) {
+
+    MX25RIndexTestResult* const result = (MX25RIndexTestResult*)context;
+
+    uint32_t key;
+    memcpy(&key, record, sizeof(key));
+
+    uint8_t expected[MX25R_INDEX_TEST_RECORD];
+    MX25RIndexTestMake(expected, key);
+
+    MX25R_TEST_CHECK(memcmp(record, expected, MX25R_INDEX_TEST_RECORD) == 0);
+    // the record being appended when the power went may have landed whole
+    MX25R_TEST_CHECK(key <= next_key && (result->count == 0 || key > result->last_key));
+
+    // the open sector and the one before it are never dropped, so a sector's worth of synced records always survives
+    const uint32_t window = MX25R_SECTOR_SIZE / (MX25R_INDEX_TEST_RECORD + 2);
+    result->window_count += has_synced && key <= synced_key && key + window > synced_key;
+
+    result->count++;
+    result->last_key = key;
+
+    return true;
+
+}
+
+/// @brief What a range query saw
+typedef struct MX25RINDEXTESTRANGE {
+
+    uint32_t min_key;           ///< Smallest key that should come back
+    uint32_t max_key;           ///< Largest key that should come back
+    uint32_t count;             ///< How many records came back
+
+} MX25RIndexTestRange;
+
+/**
+ * @brief Range query callback, checks every record is whole and in range, and comes back in key order since the keys were appended in order
+ *
+ * @param[in] context: The MX25RIndexTestRange
+ * @param[in] record: Record found
+ * @return true: Always, to see every record
+ */
+static bool MX25RIndexTestInRange(void* const context, const uint8_t* const record) {
+
+    MX25RIndexTestRange* const range = (MX25RIndexTestRange*)context;
+
+    uint32_t key;
+    memcpy(&key, record, sizeof(key));
+
+    uint8_t expected[MX25R_INDEX_TEST_RECORD];
+    MX25RIndexTestMake(expected, key);
+
+    MX25R_TEST_CHECK(memcmp(record, expected, MX25R_INDEX_TEST_RECORD) == 0);
+    MX25R_TEST_CHECK(key == range->min_key + range->count && key <= range->max_key);
+
+    range->count++;
+
+    return true;
+
+}
+
+/**
+ * @brief Runs a range query and checks how many records it finds and how much of the part it reads for them
+ *
+ * @param[in] index: Log to query
+ * @param[in] min_key: Smallest key to find
+ * @param[in] max_key: Largest key to find
+ * @param[in] sectors: How many sealed sectors the summaries can't rule out, only those are read
+ */
+static void MX25RIndexTestQueryRange(MX25RIndex* const index, const uint32_t min_key, const uint32_t max_key, const uint32_t sectors) {
+
+    // the keys appended run from MX25R_INDEX_TEST_BASE_KEY with none missing
+    const uint32_t last = MX25R_INDEX_TEST_BASE_KEY + MX25R_INDEX_TEST_RANGED - 1;
+    const uint32_t low = min_key > MX25R_INDEX_TEST_BASE_KEY ? min_key : MX25R_INDEX_TEST_BASE_KEY;
+    const uint32_t high = max_key < last ? max_key : last;
+    const uint32_t expected = low <= high ? high - low + 1 : 0;
+
+    MX25RIndexTestRange range = { low, high, 0 };
+    const uint64_t before = MX25REmulatorGetReadByteCount();
+
+    MX25R_TEST_CHECK(MX25RIndexQuery(index, min_key, max_key, MX25RIndexTestInRange, &range) == expected);
+    MX25R_TEST_CHECK(range.count == expected);
+    MX25R_TEST_CHECK(MX25REmulatorGetReadByteCount() - before == (uint64_t)sectors * MX25R_INDEX_TEST_PER_SECTOR * MX25R_INDEX_TEST_SLOT);
+
+}
+
+/**
+ * @brief Checks narrow queries only read the sectors their key range can be in, and find exactly the keys asked for wherever the records sit in a scan
+ * @note A query filters four keys at a time with SSE2 and the rest one at a time, asking for each key on its own hits every position of both
+ *
+ * @param[in] dev: Device to put the log on
+ * @param[out] index: Log to use
+ */
+static void MX25RIndexTestRanges(MX25R* const dev, MX25RIndex* const index) {
+
+    uint8_t record[MX25R_INDEX_TEST_RECORD];
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25R_TEST_CHECK(MX25RTestInit(dev) != NULL);
+    MX25R_TEST_CHECK(MX25RIndexFormat(index, dev, MX25R_INDEX_TEST_FIRST, MX25R_INDEX_TEST_COUNT, MX25R_INDEX_TEST_RECORD));
+
+    for(uint32_t i = 0; i < MX25R_INDEX_TEST_RANGED; i++) {
+        MX25RIndexTestMake(record, MX25R_INDEX_TEST_BASE_KEY + i);
+        MX25R_TEST_CHECK(MX25RIndexAppend(index, record));
+    }
+
+    MX25R_TEST_CHECK(MX25RIndexSync(index));
+
+    // the open sector holds what is left over and is read only as far as it is filled
+    const uint32_t open_count = MX25R_INDEX_TEST_RANGED - 2 * MX25R_INDEX_TEST_PER_SECTOR;
+    const uint32_t open_key = MX25R_INDEX_TEST_BASE_KEY + 2 * MX25R_INDEX_TEST_PER_SECTOR;
+
+    for(uint32_t i = 0; i < MX25R_INDEX_TEST_RANGED; i++) {
+
+        const uint32_t key = MX25R_INDEX_TEST_BASE_KEY + i;
+        MX25RIndexTestRange range = { key, key, 0 };
+
+        MX25R_TEST_CHECK(MX25RIndexQuery(index, key, key, MX25RIndexTestInRange, &range) == 1 && range.count == 1);
+
+    }
+
+    // a few keys inside one sealed sector only read that sector
+    MX25RIndexTestQueryRange(index, MX25R_INDEX_TEST_BASE_KEY + 10, MX25R_INDEX_TEST_BASE_KEY + 20, 1);
+
+    // either side of the sign bit, the filter has to compare the keys unsigned
+    MX25RIndexTestQueryRange(index, 0x7ffffffe, 0x80000001, 1);
+    MX25RIndexTestQueryRange(index, 0x80000000, open_key - 1, 1);
+
+    // across the end of one sector and the start of the next, both are read
+    MX25RIndexTestQueryRange(index, MX25R_INDEX_TEST_BASE_KEY + MX25R_INDEX_TEST_PER_SECTOR - 2, MX25R_INDEX_TEST_BASE_KEY + MX25R_INDEX_TEST_PER_SECTOR + 1, 2);
+
+    const uint64_t before = MX25REmulatorGetReadByteCount();
+    MX25RIndexTestRange range = { open_key, open_key + open_count - 1, 0 };
+    MX25R_TEST_CHECK(MX25RIndexQuery(index, open_key, 0xfffffffe, MX25RIndexTestInRange, &range) == open_count);
+    MX25R_TEST_CHECK(MX25REmulatorGetReadByteCount() - before == open_count * MX25R_INDEX_TEST_SLOT);
+
+    // keys no sector holds read nothing
+    MX25RIndexTestQueryRange(index, 0, MX25R_INDEX_TEST_BASE_KEY - 1, 0);
+    MX25RIndexTestQueryRange(index, 0x90000000, 0x90000000, 0);
+
+}
+
+/**
+ * @brief Appends records, syncing every few of them
+ *
+ * @param[in] index: Log to append to
+ * @param[in] count: How many records to append
+ */
+static void MX25RIndexTestWorkload(MX25RIndex* const index, const uint32_t count) {
+
+    uint8_t record[MX25R_INDEX_TEST_RECORD];
+
+    for(uint32_t i = 0; i < count; i++) {
+
+        MX25RIndexTestMake(record, next_key);
+        MX25R_TEST_CHECK(MX25RIndexAppend(index, record));
+        next_key++;
+
+        if(next_key % MX25R_INDEX_TEST_SYNC == 0) {
+            MX25R_TEST_CHECK(MX25RIndexSync(index));
+            synced_key = next_key - 1;
+            has_synced = true;
+        }
+
+    }
+
+}
+
+/**
+ * @brief Mounts the log and checks what a query over every key finds
+ *
+ * @param[in] dev: Device the log is on
+ * @param[out] index: Log to mount
+ */
+static void MX25RIndexTestCheck(MX25R* const dev, MX25RIndex* const index) {
+
+    MX25R_TEST_CHECK(MX25RIndexMount(index, dev, MX25R_INDEX_TEST_FIRST, MX25R_INDEX_TEST_COUNT, MX25R_INDEX_TEST_RECORD) != NULL);
+
+    MX25RIndexTestResult result = { 0, 0, 0 };
+    MX25R_TEST_CHECK(MX25RIndexQuery(index, 0, MX25R_INDEX_EMPTY_KEY - 1, MX25RIndexTestFound, &result) == result.count);
+
+    const uint32_t window = MX25R_SECTOR_SIZE / (MX25R_INDEX_TEST_RECORD + 2);
+    MX25R_TEST_CHECK(!has_synced || result.window_count == (synced_key + 1 < window ? synced_key + 1 : window));
+
+    // records lost with the power were never synced, numbering carries on from what the log holds so the keys stay in order
+    if(result.count != 0)
+        next_key = result.last_key + 1;
+
+}
+
+/// @brief What the power cut sweep works on
+typedef struct MX25RINDEXTESTSTATE {
+
+    MX25R* dev;             ///< Device the log is on
+    MX25RIndex* index;      ///< Log under test
+
+} MX25RIndexTestState;
+
+/**
+ * @brief Sweep setup, a fresh part holding the log and the keys as they were before the sweep
+ *
+ * @param[in] context: The MX25RIndexTestState
+ */
+static void MX25RIndexTestSetup(void* const context) {
+
+    MX25RIndexTestState* const state = (MX25RIndexTestState*)context;
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25REmulatorGetTiming()->sector_erase_ns = 100000;
+    memcpy(MX25REmulatorGetMemory() + MX25R_INDEX_TEST_ADDRESS, snapshot, sizeof(snapshot));
+
+    next_key = snapshot_key;
+    synced_key = snapshot_synced;
+
+    MX25RTestInit(state->dev);
+    MX25RIndexMount(state->index, state->dev, MX25R_INDEX_TEST_FIRST, MX25R_INDEX_TEST_COUNT, MX25R_INDEX_TEST_RECORD);
+
+}
+
+/**
+ * @brief Sweep workload, the same run of appends that was counted without a cut
+ *
+ * @param[in] context: The MX25RIndexTestState
+ */
+static void MX25RIndexTestWorkloadCut(void* const context) { MX25RIndexTestWorkload(((MX25RIndexTestState*)context)->index, 300); }
+
+/**
+ * @brief Sweep check, back up after the power loss the log has to mount, hold every synced record and keep taking new ones
+ *
+ * @param[in] context: The MX25RIndexTestState
+ */
+static void MX25RIndexTestCheckCut(void* const context) {
+
+    MX25RIndexTestState* const state = (MX25RIndexTestState*)context;
+
+    MX25RTestInit(state->dev);
+    MX25RIndexTestCheck(state->dev, state->index);
+
+    MX25RIndexTestWorkload(state->index, 2 * MX25R_INDEX_TEST_SYNC);
+    MX25RIndexTestCheck(state->dev, state->index);
+
+}
+
+int main(void) {
+
+    static MX25RIndex index;
+    MX25R dev;
+
+    MX25RIndexTestRanges(&dev, &index);
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25REmulatorGetTiming()->sector_erase_ns = 100000;
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+
+    // a region that never held a log formats without a mount
+    MX25R_TEST_CHECK(MX25RIndexMount(&index, &dev, MX25R_INDEX_TEST_FIRST, MX25R_INDEX_TEST_COUNT, MX25R_INDEX_TEST_RECORD) == NULL);
+    MX25R_TEST_CHECK(MX25RIndexFormat(&index, &dev, MX25R_INDEX_TEST_FIRST, MX25R_INDEX_TEST_COUNT, MX25R_INDEX_TEST_RECORD));
+
+    // wrap the log until the summary table is about to be compacted, so the sweep below runs into it
+    while(index.table_next + 3 < MX25R_INDEX_TEST_ENTRIES)
+        MX25RIndexTestWorkload(&index, 50);
+
+    MX25RIndexTestWorkload(&index, MX25R_INDEX_TEST_SYNC);
+    MX25RIndexTestCheck(&dev, &index);
+
+    memcpy(snapshot, MX25REmulatorGetMemory() + MX25R_INDEX_TEST_ADDRESS, sizeof(snapshot));
+    snapshot_key = next_key;
+    snapshot_synced = synced_key;
+
+    // a cut at every program and erase of a run that seals sectors and compacts the table
+    const uint32_t before = MX25REmulatorGetOperationCount();
+    MX25RIndexTestWorkload(&index, 300);
+    const uint32_t operations = MX25REmulatorGetOperationCount() - before;
+
+    MX25RIndexTestState state = { &dev, &index };
+    const MX25RTestSweep sweep = { MX25RIndexTestSetup, MX25RIndexTestWorkloadCut, MX25RIndexTestCheckCut, &state };
+    const uint8_t percents[] = { 0, 50, 100 };
+
+    MX25RTestSweepCuts(&sweep, operations, percents, sizeof(percents));
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("index");
+
+}
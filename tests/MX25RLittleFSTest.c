@@ -0,0 +1,113 @@
+/**
+ * @file MX25RLittleFSTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks the littlefs block device callbacks against the emulated part, built only with MX25R_BUILD_LITTLEFS
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+#include "MX25RLittleFS.h"
+
+#include <string.h>
+
+#define MX25R_LITTLEFS_TEST_FIRST   16      ///< First sector of the file system
+#define MX25R_LITTLEFS_TEST_BLOCK   3       ///< Block the callbacks are run on
+
+int main(void) {
+
+    static MX25RLittleFS fs;
+    MX25R dev;
+
+    uint8_t data[2 * MX25R_PAGE_SIZE], out[2 * MX25R_PAGE_SIZE];
+    for(uint16_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 7);
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+
+    // every sector from the first one to the end of the part is a block, one lookahead bit each
+    const struct lfs_config* c = MX25RLittleFSInit(&fs, &dev, MX25R_LITTLEFS_TEST_FIRST, 0);
+    MX25R_TEST_CHECK(c != NULL);
+
+    const uint32_t blocks = MX25R_TEST_CAPACITY / MX25R_SECTOR_SIZE - MX25R_LITTLEFS_TEST_FIRST;
+    MX25R_TEST_CHECK(c->block_size == MX25R_SECTOR_SIZE && c->prog_size == MX25R_PAGE_SIZE && c->block_count == blocks);
+    MX25R_TEST_CHECK(c->lookahead_size % 8 == 0 && c->lookahead_size * 8 >= blocks);
+
+    MX25R_TEST_CHECK(MX25RLittleFSInit(&fs, &dev, MX25R_TEST_CAPACITY / MX25R_SECTOR_SIZE, 0) == NULL);
+    MX25R_TEST_CHECK(MX25RLittleFSInit(&fs, &dev, MX25R_LITTLEFS_TEST_FIRST, (uint16_t)(blocks + 1)) == NULL);
+
+    c = MX25RLittleFSInit(&fs, &dev, MX25R_LITTLEFS_TEST_FIRST, 0);
+
+    uint8_t* const block = MX25REmulatorGetMemory() + (uint32_t)(MX25R_LITTLEFS_TEST_FIRST + MX25R_LITTLEFS_TEST_BLOCK) * MX25R_SECTOR_SIZE;
+    memset(block, 0x00, MX25R_SECTOR_SIZE);
+
+    // the erase is left running, the read after it has to wait for it
+    MX25R_TEST_CHECK(c->erase(c, MX25R_LITTLEFS_TEST_BLOCK) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(c->read(c, MX25R_LITTLEFS_TEST_BLOCK, 0, out, 16) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(out[0] == 0xff && out[15] == 0xff && block[MX25R_SECTOR_SIZE - 1] == 0xff);
+
+    // two pages programmed and read back across the page boundary, the rest of the block stays erased
+    MX25R_TEST_CHECK(c->prog(c, MX25R_LITTLEFS_TEST_BLOCK, 2 * MX25R_PAGE_SIZE, data, sizeof(data)) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(c->read(c, MX25R_LITTLEFS_TEST_BLOCK, 2 * MX25R_PAGE_SIZE - 12, out, 100) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(out[0] == 0xff && memcmp(out + 12, data, 88) == 0);
+
+    MX25R_TEST_CHECK(c->sync(c) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(memcmp(block + 2 * MX25R_PAGE_SIZE, data, sizeof(data)) == 0);
+    MX25R_TEST_CHECK(block[0] == 0xff && block[4 * MX25R_PAGE_SIZE] == 0xff);
+    MX25R_TEST_CHECK(!MX25RIsWriteInProgress(&dev));
+
+    // a program cut by a power loss leaves the page before it whole and the block device usable once it is set up again
+    MX25REmulatorSchedulePowerCut(1, 50, MX25RTestCut);
+
+    if(setjmp(mx25r_test_cut_point) == 0) {
+        c->prog(c, MX25R_LITTLEFS_TEST_BLOCK, 6 * MX25R_PAGE_SIZE, data, sizeof(data));
+        c->sync(c);
+        MX25R_TEST_CHECK(!"the program should have been cut");
+    }
+
+    MX25R_TEST_CHECK(memcmp(block + 6 * MX25R_PAGE_SIZE, data, MX25R_PAGE_SIZE) == 0);
+    MX25R_TEST_CHECK(block[8 * MX25R_PAGE_SIZE - 1] == 0xff);
+
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+    c = MX25RLittleFSInit(&fs, &dev, MX25R_LITTLEFS_TEST_FIRST, 0);
+    MX25R_TEST_CHECK(c != NULL);
+
+    MX25R_TEST_CHECK(c->erase(c, MX25R_LITTLEFS_TEST_BLOCK) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(c->prog(c, MX25R_LITTLEFS_TEST_BLOCK, 0, data, sizeof(data)) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(c->read(c, MX25R_LITTLEFS_TEST_BLOCK, 0, out, sizeof(out)) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(memcmp(out, data, sizeof(data)) == 0 && block[6 * MX25R_PAGE_SIZE] == 0xff);
+    MX25R_TEST_CHECK(c->sync(c) == LFS_ERR_OK);
+
+    #ifdef MX25R_LITTLEFS_TEST_MOUNT
+    // built along with the littlefs sources, a real file system formats, mounts and keeps a file across a remount
+    lfs_t lfs;
+    lfs_file_t file;
+
+    c = MX25RLittleFSInit(&fs, &dev, MX25R_LITTLEFS_TEST_FIRST, 16);
+    MX25R_TEST_CHECK(c != NULL);
+    MX25R_TEST_CHECK(lfs_format(&lfs, c) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(lfs_mount(&lfs, c) == LFS_ERR_OK);
+
+    MX25R_TEST_CHECK(lfs_file_open(&lfs, &file, "data", LFS_O_WRONLY | LFS_O_CREAT) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(lfs_file_write(&lfs, &file, data, sizeof(data)) == (lfs_ssize_t)sizeof(data));
+    MX25R_TEST_CHECK(lfs_file_close(&lfs, &file) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(lfs_unmount(&lfs) == LFS_ERR_OK);
+
+    memset(out, 0x00, sizeof(out));
+    MX25R_TEST_CHECK(lfs_mount(&lfs, c) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(lfs_file_open(&lfs, &file, "data", LFS_O_RDONLY) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(lfs_file_read(&lfs, &file, out, sizeof(out)) == (lfs_ssize_t)sizeof(out));
+    MX25R_TEST_CHECK(memcmp(out, data, sizeof(data)) == 0);
+    MX25R_TEST_CHECK(lfs_file_close(&lfs, &file) == LFS_ERR_OK);
+    MX25R_TEST_CHECK(lfs_unmount(&lfs) == LFS_ERR_OK);
+    #endif
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("littlefs");
+
+}
@@ -0,0 +1,70 @@
+/**
+ * @file MX25RPartTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks the part geometry, the address types and the MX25R_STATIC_* macros, MX25RPartTest.cpp builds it again as C++
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+// the static macros only exist with a part selected, pick one when the build didn't
+#if !defined(MX25R8035F) && !defined(MX25R1635F) && !defined(MX25R3235F) && !defined(MX25R6435F)
+#define MX25R1635F
+#endif
+
+#include "MX25RTest.h"
+
+/**
+ * @brief Uses the static macros as case labels, which only compiles if they are constants
+ *
+ * @param[in] sector: Sector to look up
+ * @return int: Which of the cases it hit
+ */
+static int MX25RPartTestCase(const MX25RSector sector) {
+
+    switch(sector) {
+
+        case MX25R_STATIC_SECTOR(0):                        return 1;
+        case MX25R_STATIC_SECTOR(MX25R_SECTOR_COUNT - 1):   return 2;
+        default:                                            return 0;
+
+    }
+
+}
+
+int main(void) {
+
+    // one past the end of the largest part fits every address type, so a caller running off the end is caught instead of wrapping
+    MX25R_TEST_CHECK((MX25RPage)((1ul << 23) / MX25R_PAGE_SIZE) == (1ul << 23) / MX25R_PAGE_SIZE);
+    MX25R_TEST_CHECK((MX25RSector)((1ul << 23) / MX25R_SECTOR_SIZE) == (1ul << 23) / MX25R_SECTOR_SIZE);
+    MX25R_TEST_CHECK((MX25RSmallBlock)((1ul << 23) / MX25R_SMALL_BLOCK_SIZE) == (1ul << 23) / MX25R_SMALL_BLOCK_SIZE);
+    MX25R_TEST_CHECK((MX25RBlock)((1ul << 23) / MX25R_BLOCK_SIZE) == (1ul << 23) / MX25R_BLOCK_SIZE);
+
+    MX25R_TEST_CHECK(MX25R_PAGE_COUNT * MX25R_PAGE_SIZE == MX25R_CAPACITY && MX25R_SECTOR_COUNT * MX25R_SECTOR_SIZE == MX25R_CAPACITY);
+    MX25R_TEST_CHECK(MX25R_SMALL_BLOCK_COUNT * MX25R_SMALL_BLOCK_SIZE == MX25R_CAPACITY && MX25R_BLOCK_COUNT * MX25R_BLOCK_SIZE == MX25R_CAPACITY);
+    MX25R_TEST_CHECK((1L << MX25R_DENSITY_ID) == MX25R_CAPACITY);
+
+    // the macros give back the address they were handed, as the type it goes to the driver as
+    MX25R_TEST_CHECK(MX25R_STATIC_PAGE(MX25R_PAGE_COUNT - 1) == MX25R_PAGE_COUNT - 1);
+    MX25R_TEST_CHECK(MX25R_STATIC_SECTOR(MX25R_SECTOR_COUNT - 1) == MX25R_SECTOR_COUNT - 1);
+    MX25R_TEST_CHECK(MX25R_STATIC_SMALL_BLOCK(MX25R_SMALL_BLOCK_COUNT - 1) == MX25R_SMALL_BLOCK_COUNT - 1);
+    MX25R_TEST_CHECK(MX25R_STATIC_BLOCK(MX25R_BLOCK_COUNT - 1) == MX25R_BLOCK_COUNT - 1);
+    MX25R_TEST_CHECK(sizeof(MX25R_STATIC_SECTOR(0)) == sizeof(MX25RSector));
+
+    MX25R_TEST_CHECK(MX25RPartTestCase(0) == 1 && MX25RPartTestCase(MX25R_SECTOR_COUNT - 1) == 2 && MX25RPartTestCase(1) == 0);
+
+    // built on its own with one of these defined the test has to fail to compile, ctest checks that it does
+    #ifdef MX25R_PART_TEST_OUT_OF_RANGE
+    MX25R_TEST_CHECK(MX25R_STATIC_SECTOR(MX25R_SECTOR_COUNT) == 0);
+    #endif
+
+    #ifdef MX25R_PART_TEST_NOT_CONSTANT
+    const volatile int sector = 1;
+    MX25R_TEST_CHECK(MX25R_STATIC_SECTOR(sector) == 1);
+    #endif
+
+    return MX25RTestResult("part");
+
+}
@@ -0,0 +1,12 @@
+/**
+ * @file MX25RPartTest.cpp
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Builds MX25RPartTest.c as C++, the header and its static macros have to work from C++ firmware too
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RPartTest.c"
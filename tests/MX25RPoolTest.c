@@ -0,0 +1,238 @@
+/**
+ * @file MX25RPoolTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that a pool never hands out a sector whose erase was cut by a power loss
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+#include "MX25RPool.h"
+
+#include <string.h>
+
+#define MX25R_POOL_TEST_FIRST   16      ///< First sector of the pool's region
+#define MX25R_POOL_TEST_COUNT   12      ///< How many sectors the region has
+#define MX25R_POOL_TEST_TARGET  4       ///< How many erased sectors the pool keeps ready
+#define MX25R_POOL_TEST_SCRATCH 100     ///< Sector the writer programs into while the pool erases
+
+/**
+ * @brief Marks every sector of the region as used, at both ends so a partial erase still shows
+ */
+static void MX25RPoolTestDirty(void) {
+
+    uint8_t* const memory = MX25REmulatorGetMemory();
+
+    for(uint16_t sector = 0; sector < MX25R_POOL_TEST_COUNT; sector++) {
+
+        uint8_t* const start = memory + (uint32_t)(MX25R_POOL_TEST_FIRST + sector) * MX25R_SECTOR_SIZE;
+        memset(start, 0x00, 16);
+        memset(start + MX25R_SECTOR_SIZE - 16, 0x00, 16);
+
+    }
+
+}
+
+/**
+ * @brief Checks if a sector is erased, straight from the emulated array
+ *
+ * @param[in] sector: Sector to check
+ * @return true: If every byte is erased
+ * @return false: If anything is programmed
+ */
+static bool MX25RPoolTestIsBlank(const uint16_t sector) {
+
+    const uint8_t* const start = MX25REmulatorGetMemory() + (uint32_t)sector * MX25R_SECTOR_SIZE;
+
+    for(uint32_t i = 0; i < MX25R_SECTOR_SIZE; i++)
+        if(start[i] != 0xff)
+            return false;
+
+    return true;
+
+}
+
+/**
+ * @brief Releases every sector and keeps allocating and releasing while a writer yields the erases to program elsewhere
+ *
+ * @param[in] dev: Device the pool is on
+ * @param[in] pool: Pool to run
+ */
+static void MX25RPoolTestWorkload(MX25R* const dev, MX25RPool* const pool) {
+
+    static uint8_t page[MX25R_PAGE_SIZE];
+    memset(page, 0x5a, sizeof(page));
+
+    for(uint16_t sector = 0; sector < MX25R_POOL_TEST_COUNT; sector++)
+        MX25RPoolRelease(pool, MX25R_POOL_TEST_FIRST + sector);
+
+    for(uint32_t step = 0; step < 400; step++) {
+
+        MX25RPoolService(pool);
+
+        if(step % 5 == 0) {
+
+            MX25RPoolYield(pool);
+
+            MX25REnableWriting(dev);
+            MX25RPageProgram(dev, (MX25RPage)(MX25R_POOL_TEST_SCRATCH * (MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE) + step % 16), page, MX25R_PAGE_SIZE);
+            while(MX25RIsWriteInProgress(dev));
+
+        }
+
+        // what is handed out gets used and comes back later
+        uint16_t sector;
+        if(step % 7 == 0 && MX25RPoolAllocate(pool, &sector)) {
+
+            MX25R_TEST_CHECK(MX25RPoolTestIsBlank(sector));
+
+            MX25REnableWriting(dev);
+            MX25RPageProgram(dev, (MX25RPage)(sector * (MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE)), page, MX25R_PAGE_SIZE);
+            while(MX25RIsWriteInProgress(dev));
+
+            MX25RPoolRelease(pool, sector);
+
+        }
+
+    }
+
+    for(uint32_t step = 0; step < 1000 && MX25RPoolReadyCount(pool) < MX25R_POOL_TEST_TARGET; step++)
+        MX25RPoolService(pool);
+
+}
+
+/**
+ * @brief Sets up a fresh part with a used region, erases are made short so the pool turns over many times
+ */
+static void MX25RPoolTestPart(void) {
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25REmulatorGetTiming()->sector_erase_ns = 100000;
+    MX25RPoolTestDirty();
+
+}
+
+/**
+ * @brief Releases a sector the lazy scan has not reached yet and hands out everything the pool gives, the scan must not find that sector blank and hand it out again
+ *
+ * @param[in] dev: Device the pool is on
+ * @param[in] pool: Pool to run
+ */
+static void MX25RPoolTestReleaseAhead(MX25R* const dev, MX25RPool* const pool) {
+
+    uint16_t handed[2 * MX25R_POOL_TEST_COUNT];
+    uint8_t handed_count = 0;
+
+    // only the first few sectors are blank, so setting up the pool scans no further than them
+    MX25RPoolTestPart();
+    memset(MX25REmulatorGetMemory() + (uint32_t)MX25R_POOL_TEST_FIRST * MX25R_SECTOR_SIZE, 0xff, (uint32_t)MX25R_POOL_TEST_TARGET * MX25R_SECTOR_SIZE);
+    MX25RTestInit(dev);
+
+    MX25R_TEST_CHECK(MX25RPoolInit(pool, dev, MX25R_POOL_TEST_FIRST, MX25R_POOL_TEST_COUNT, MX25R_POOL_TEST_TARGET, NULL) != NULL);
+    MX25R_TEST_CHECK(MX25RPoolReadyCount(pool) == MX25R_POOL_TEST_TARGET);
+    MX25R_TEST_CHECK(MX25RPoolRelease(pool, MX25R_POOL_TEST_FIRST + MX25R_POOL_TEST_COUNT - 1));
+
+    // what is handed out is left blank, as a caller that has not written to it yet would
+    for(uint32_t step = 0; step < 1000; step++) {
+
+        MX25RPoolService(pool);
+
+        uint16_t sector;
+        while(MX25RPoolAllocate(pool, &sector) && handed_count < sizeof(handed) / sizeof(handed[0]))
+            handed[handed_count++] = sector;
+
+    }
+
+    MX25R_TEST_CHECK(handed_count == MX25R_POOL_TEST_TARGET + 1);
+
+    for(uint8_t i = 0; i < handed_count; i++)
+        for(uint8_t j = 0; j < i; j++)
+            MX25R_TEST_CHECK(handed[i] != handed[j]);
+
+}
+
+/// @brief What the power cut sweep works on
+typedef struct MX25RPOOLTESTSTATE {
+
+    MX25R* dev;         ///< Device the pool is on
+    MX25RPool* pool;    ///< Pool under test
+
+} MX25RPoolTestState;
+
+/**
+ * @brief Sweep setup, a fresh part with a pool set up on it
+ *
+ * @param[in] context: The MX25RPoolTestState
+ */
+static void MX25RPoolTestSetup(void* const context) {
+
+    MX25RPoolTestState* const state = (MX25RPoolTestState*)context;
+
+    MX25RPoolTestPart();
+    MX25RTestInit(state->dev);
+    MX25RPoolInit(state->pool, state->dev, MX25R_POOL_TEST_FIRST, MX25R_POOL_TEST_COUNT, MX25R_POOL_TEST_TARGET, NULL);
+
+}
+
+/**
+ * @brief Sweep workload, the same one the pool runs without a cut
+ *
+ * @param[in] context: The MX25RPoolTestState
+ */
+static void MX25RPoolTestWorkloadCut(void* const context) {
+
+    MX25RPoolTestState* const state = (MX25RPoolTestState*)context;
+    MX25RPoolTestWorkload(state->dev, state->pool);
+
+}
+
+/**
+ * @brief Sweep check, back up after the power loss whatever the blank check finds has to really be erased
+ *
+ * @param[in] context: The MX25RPoolTestState
+ */
+static void MX25RPoolTestCheck(void* const context) {
+
+    MX25RPoolTestState* const state = (MX25RPoolTestState*)context;
+
+    MX25RTestInit(state->dev);
+    MX25R_TEST_CHECK(MX25RPoolInit(state->pool, state->dev, MX25R_POOL_TEST_FIRST, MX25R_POOL_TEST_COUNT, MX25R_POOL_TEST_TARGET, NULL) != NULL);
+
+    uint16_t sector;
+    while(MX25RPoolAllocate(state->pool, &sector))
+        MX25R_TEST_CHECK(MX25RPoolTestIsBlank(sector));
+
+}
+
+int main(void) {
+
+    static MX25RPool pool;
+    MX25R dev;
+
+    MX25RPoolTestReleaseAhead(&dev, &pool);
+
+    // a run with no cut, to count the cut points and check the pool fills
+    MX25RPoolTestPart();
+    MX25RTestInit(&dev);
+
+    MX25R_TEST_CHECK(MX25RPoolInit(&pool, &dev, MX25R_POOL_TEST_FIRST, MX25R_POOL_TEST_COUNT, MX25R_POOL_TEST_TARGET, NULL) != NULL);
+    MX25R_TEST_CHECK(MX25RPoolReadyCount(&pool) == 0);
+
+    MX25RPoolTestWorkload(&dev, &pool);
+    MX25R_TEST_CHECK(MX25RPoolReadyCount(&pool) == MX25R_POOL_TEST_TARGET);
+
+    // a power cut anywhere in the workload never leaves a half erased sector for the pool to hand out
+    MX25RPoolTestState state = { &dev, &pool };
+    const MX25RTestSweep sweep = { MX25RPoolTestSetup, MX25RPoolTestWorkloadCut, MX25RPoolTestCheck, &state };
+    const uint8_t percents[] = { 0, 50, 100 };
+
+    MX25RTestSweepCuts(&sweep, MX25REmulatorGetOperationCount(), percents, sizeof(percents));
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("pool");
+
+}
@@ -0,0 +1,176 @@
+/**
+ * @file MX25RPowerTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that the power governor steps the part down and puts it to sleep when idle, wakes it for the next command and leaves it alone while busy
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+#include "MX25RPower.h"
+
+#include <string.h>
+
+#define MX25R_POWER_TEST_SECTOR     8                   ///< Sector the test programs and erases
+#define MX25R_POWER_TEST_HIGH_PERF  (1 << 1)            ///< L/H bit of the second configuration byte, set in high performance mode
+#define MX25R_POWER_TEST_WEL        (1 << 1)            ///< Write enable latch bit of the status register
+
+static uint32_t now_us;     ///< The governor's clock, moved on by hand so the test picks when the part goes idle
+
+/**
+ * @brief Clock handed to the governor
+ *
+ * @return uint32_t: Microseconds the test has let pass
+ */
+static uint32_t MX25RPowerTestNow(void) { return now_us; }
+
+/**
+ * @brief Wake delay handed to the governor, the emulated part ignores commands until it has passed
+ *
+ * @param[in] us: How long to wait
+ */
+static void MX25RPowerTestDelay(const uint32_t us) { MX25REmulatorWait((uint64_t)us * 1000); }
+
+/**
+ * @brief Checks if the part runs in high performance mode, straight from the emulated registers
+ *
+ * @return true: If it is in high performance mode
+ */
+static bool MX25RPowerTestIsHighPerformance(void) {
+
+    uint8_t status, config[2], security;
+    MX25REmulatorPeekRegisters(&status, config, &security);
+
+    return config[1] & MX25R_POWER_TEST_HIGH_PERF;
+
+}
+
+/**
+ * @brief Checks if the part has its write enable latch set, straight from the emulated registers
+ *
+ * @return true: If WEL is set
+ */
+static bool MX25RPowerTestIsWriteEnabled(void) {
+
+    uint8_t status, config[2], security;
+    MX25REmulatorPeekRegisters(&status, config, &security);
+
+    return status & MX25R_POWER_TEST_WEL;
+
+}
+
+/**
+ * @brief Lets the part sit idle for a while and then services the governor
+ *
+ * @param[in] power: Governor to service
+ * @param[in] idle_us: How long nothing happens
+ */
+static void MX25RPowerTestIdle(MX25RPower* const power, const uint32_t idle_us) {
+
+    now_us += idle_us;
+    MX25R_TEST_CHECK(MX25RPowerService(power));
+
+}
+
+int main(void) {
+
+    static MX25RPower power;
+    MX25R dev;
+
+    uint8_t page[MX25R_PAGE_SIZE], out[MX25R_PAGE_SIZE];
+    for(uint16_t i = 0; i < MX25R_PAGE_SIZE; i++)
+        page[i] = (uint8_t)(i * 3);
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+    MX25R_TEST_CHECK(MX25RPowerInit(&power, &dev, MX25RPowerTestNow, MX25RPowerTestDelay) != NULL);
+
+    uint8_t* const memory = MX25REmulatorGetMemory();
+    const uint32_t address = (uint32_t)MX25R_POWER_TEST_SECTOR * MX25R_SECTOR_SIZE;
+    const MX25RPage first_page = (MX25RPage)(address / MX25R_PAGE_SIZE);
+    memcpy(memory + address, page, sizeof(page));
+
+    // a burst of queued work switches to high performance, once it is done and the part sits idle it drops back and then sleeps
+    MX25R_TEST_CHECK(MX25RPowerQueue(&power, MX25R_POWER_BURST_PENDING));
+    MX25R_TEST_CHECK(MX25RPowerTestIsHighPerformance());
+    MX25RPowerComplete(&power, MX25R_POWER_BURST_PENDING);
+
+    const uint32_t timeout = MX25RPowerIdleTimeout(&power);
+
+    MX25RPowerTestIdle(&power, timeout / 2);
+    MX25R_TEST_CHECK(!MX25RPowerTestIsHighPerformance() && !MX25REmulatorIsAsleep());
+
+    MX25RPowerTestIdle(&power, timeout / 2);
+    MX25R_TEST_CHECK(MX25REmulatorIsAsleep());
+
+    // the next command wakes it and waits out tRDP, a read too early would come back as 0xff
+    memset(out, 0x00, sizeof(out));
+    MX25R_TEST_CHECK(MX25RRead(&dev, address, out, sizeof(out)));
+    MX25R_TEST_CHECK(!MX25REmulatorIsAsleep() && memcmp(out, page, sizeof(out)) == 0);
+
+    // a running erase keeps it awake
+    MX25R_TEST_CHECK(MX25REnableWriting(&dev) && MX25REraseSector(&dev, MX25R_POWER_TEST_SECTOR));
+
+    MX25RPowerTestIdle(&power, MX25R_POWER_MAX_IDLE_US);
+    MX25R_TEST_CHECK(!MX25REmulatorIsAsleep());
+
+    // and so does a suspended one, deep sleep would lose it
+    MX25R_TEST_CHECK(MX25RSuspend(&dev));
+    while(MX25RIsWriteInProgress(&dev));
+
+    MX25RPowerTestIdle(&power, MX25R_POWER_MAX_IDLE_US);
+    MX25R_TEST_CHECK(!MX25REmulatorIsAsleep());
+
+    MX25R_TEST_CHECK(MX25RResume(&dev));
+    while(MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RVerifyErase(&dev) && memory[address] == 0xff);
+
+    MX25RPowerTestIdle(&power, MX25R_POWER_MAX_IDLE_US);
+    MX25R_TEST_CHECK(MX25REmulatorIsAsleep());
+
+    // write enable taken before a burst switches modes is still there once the switch is done
+    MX25R_TEST_CHECK(MX25REnableWriting(&dev));
+    MX25R_TEST_CHECK(MX25RPowerQueue(&power, MX25R_POWER_BURST_PENDING));
+    MX25R_TEST_CHECK(MX25RPowerTestIsHighPerformance() && MX25RPowerTestIsWriteEnabled());
+
+    MX25R_TEST_CHECK(MX25RPageProgram(&dev, first_page, page, MX25R_PAGE_SIZE));
+    while(MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RVerifyProgram(&dev) && memcmp(memory + address, page, sizeof(page)) == 0);
+    MX25RPowerComplete(&power, MX25R_POWER_BURST_PENDING);
+
+    // a step down while idle clears the latch on the part, the caller still sees write enable and it is sent again before the program
+    MX25R_TEST_CHECK(MX25REnableWriting(&dev));
+    MX25RPowerTestIdle(&power, MX25RPowerIdleTimeout(&power) / 2);
+
+    MX25R_TEST_CHECK(!MX25RPowerTestIsHighPerformance() && !MX25RPowerTestIsWriteEnabled());
+    MX25R_TEST_CHECK(MX25RIsWritingEnabled(&dev));
+
+    // a read in between doesn't need it, so it doesn't send it
+    MX25R_TEST_CHECK(MX25RRead(&dev, address, out, sizeof(out)));
+    MX25R_TEST_CHECK(!MX25RPowerTestIsWriteEnabled() && MX25RIsWritingEnabled(&dev));
+
+    MX25R_TEST_CHECK(MX25RPageProgram(&dev, (MX25RPage)(first_page + 1), page, MX25R_PAGE_SIZE));
+    while(MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RVerifyProgram(&dev) && memcmp(memory + address + MX25R_PAGE_SIZE, page, sizeof(page)) == 0);
+    MX25R_TEST_CHECK(!MX25RIsWritingEnabled(&dev));
+
+    // turning write enable off in between means it stays off
+    MX25R_TEST_CHECK(MX25RPowerQueue(&power, MX25R_POWER_BURST_PENDING));
+    MX25RPowerComplete(&power, MX25R_POWER_BURST_PENDING);
+    MX25R_TEST_CHECK(MX25REnableWriting(&dev));
+    MX25RPowerTestIdle(&power, MX25RPowerIdleTimeout(&power) / 2);
+
+    MX25R_TEST_CHECK(MX25RDisableWriting(&dev));
+    MX25R_TEST_CHECK(!MX25RIsWritingEnabled(&dev) && !MX25RPowerTestIsWriteEnabled());
+
+    MX25RPowerDeinit(&power);
+    MX25R_TEST_CHECK(dev.power == NULL);
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("power");
+
+}
@@ -0,0 +1,159 @@
+/**
+ * @file MX25RShadowTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that the register shadow answers queries without the bus once it is valid, and that raw commands and resets throw it away
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+
+#include <string.h>
+
+static uint32_t last_count;     ///< Transactions seen by the last call to MX25RShadowTestTransactions
+
+/**
+ * @brief Sends a raw command in a transaction of its own, MX25RWriteCommand leaves CS to the caller
+ *
+ * @param[in] dev: Device to send it to
+ * @param[in] cmd: Command to send
+ * @param[in] args: Arguments to the command, NULL if there are none
+ * @param[in] args_size: How many arguments
+ * @return uint8_t: Status, 0 if there was an error
+ */
+static uint8_t MX25RShadowTestRaw(MX25R* const dev, const MX25RCommand cmd, const uint8_t* const args, const uint8_t args_size) {
+
+    dev->hal.select_chip(true);
+    const uint8_t ret = MX25RWriteCommand(dev, cmd, args, args_size);
+    dev->hal.select_chip(false);
+
+    return ret;
+
+}
+
+/**
+ * @brief Counts the bus transactions since it was last called
+ *
+ * @return uint32_t: How many times CS was pulled low in between
+ */
+static uint32_t MX25RShadowTestTransactions(void) {
+
+    const uint32_t count = MX25REmulatorGetTransactionCount();
+    const uint32_t since = count - last_count;
+    last_count = count;
+
+    return since;
+
+}
+
+/**
+ * @brief Waits for the running program or erase to finish
+ *
+ * @param[in] dev: Device to wait on
+ */
+static void MX25RShadowTestWait(MX25R* const dev) { while(MX25RIsWriteInProgress(dev)); }
+
+int main(void) {
+
+    MX25R dev;
+    uint8_t page[MX25R_PAGE_SIZE];
+    memset(page, 0x5a, sizeof(page));
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+
+    uint8_t* const memory = MX25REmulatorGetMemory();
+
+    // the part may still be busy from before init, so the first query reads WIP and the next one doesn't
+    MX25RShadowTestTransactions();
+    MX25R_TEST_CHECK(!MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25R_TEST_CHECK(!MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 0);
+
+    // the security register is read once the erase is done, after that both verifies come from the shadow
+    MX25R_TEST_CHECK(MX25REnableWriting(&dev) && MX25REraseSector(&dev, 1));
+    MX25RShadowTestWait(&dev);
+    MX25RShadowTestTransactions();
+
+    MX25R_TEST_CHECK(MX25RVerifyErase(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25R_TEST_CHECK(MX25RVerifyErase(&dev) && MX25RVerifyProgram(&dev));
+    MX25R_TEST_CHECK(!MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 0);
+
+    // a program throws the security shadow away again
+    MX25R_TEST_CHECK(MX25REnableWriting(&dev) && MX25RPageProgram(&dev, MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE, page, MX25R_PAGE_SIZE));
+    MX25RShadowTestWait(&dev);
+    MX25RShadowTestTransactions();
+
+    MX25R_TEST_CHECK(MX25RVerifyProgram(&dev) && memory[MX25R_SECTOR_SIZE] == 0x5a);
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25R_TEST_CHECK(MX25RVerifyProgram(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 0);
+
+    // the configuration register is read once, asking for the mode the part is already in is then free
+    MX25R_TEST_CHECK(MX25RSetLowPowerMode(&dev, true));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25R_TEST_CHECK(MX25RSetLowPowerMode(&dev, true));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 0);
+
+    // a real switch goes out, and once it has landed asking for it again is free too
+    MX25R_TEST_CHECK(MX25RSetLowPowerMode(&dev, false));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() > 0);
+    MX25RShadowTestWait(&dev);
+
+    uint8_t status, config[2], security;
+    MX25REmulatorPeekRegisters(&status, config, &security);
+    MX25R_TEST_CHECK(config[1] & (1 << 1));
+
+    MX25RShadowTestTransactions();
+    MX25R_TEST_CHECK(MX25RSetLowPowerMode(&dev, false));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 0);
+
+    // a raw command could have started anything, so WIP and the registers come off the bus again
+    const uint8_t erase_args[] = { 0x00, (uint8_t)((2 * MX25R_SECTOR_SIZE) >> 8), 0x00 };
+    memory[2 * MX25R_SECTOR_SIZE] = 0x00;
+
+    MX25R_TEST_CHECK(MX25RShadowTestRaw(&dev, MX25R_WRITE_EN, NULL, 0));
+    MX25R_TEST_CHECK(MX25RShadowTestRaw(&dev, MX25R_SECT_ERASE, erase_args, sizeof(erase_args)));
+    MX25RShadowTestTransactions();
+
+    MX25R_TEST_CHECK(MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25RShadowTestWait(&dev);
+    MX25R_TEST_CHECK(memory[2 * MX25R_SECTOR_SIZE] == 0xff);
+
+    MX25RShadowTestTransactions();
+    MX25R_TEST_CHECK(MX25RSetLowPowerMode(&dev, false));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25R_TEST_CHECK(MX25RVerifyErase(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    // and so does a reset
+    MX25R_TEST_CHECK(MX25RReset(&dev));
+    MX25RShadowTestTransactions();
+
+    MX25R_TEST_CHECK(!MX25RIsWriteInProgress(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25R_TEST_CHECK(MX25RVerifyErase(&dev));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25R_TEST_CHECK(MX25RSetLowPowerMode(&dev, false));
+    MX25R_TEST_CHECK(MX25RShadowTestTransactions() == 1);
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("shadow");
+
+}
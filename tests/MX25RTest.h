@@ -0,0 +1,118 @@
+/**
+ * @file MX25RTest.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Checks and the Power Cut Harness shared by the tests that run against the emulated part
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_TEST_H
+#define MX25R_TEST_H
+
+#include "MX25R.h"
+#include "MX25REmulator.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+
+#ifdef MX25R_CAPACITY
+#define MX25R_TEST_CAPACITY     MX25R_CAPACITY  ///< Size of the emulated part every test runs on, the part the driver is built for
+#else
+#define MX25R_TEST_CAPACITY     (1ul << 21)     ///< Size of the emulated part every test runs on, an MX25R1635F
+#endif
+
+/// @brief Counts a failed check and says where it was, the test keeps going so one run shows every failure
+#define MX25R_TEST_CHECK(condition) \
+    do { if(!(condition)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); mx25r_test_failures++; } } while(0)
+
+static unsigned mx25r_test_failures;   ///< How many checks failed so far
+static jmp_buf mx25r_test_cut_point;   ///< Where a power cut unwinds to
+
+/**
+ * @brief Power cut callback for the emulator, unwinds out of whatever driver call the cut happened in
+ */
+static inline void MX25RTestCut(void) { longjmp(mx25r_test_cut_point, 1); }
+
+/// @brief A power cut sweep, setup, workload and check run again for every cut point and are each handed the context
+typedef struct MX25RTESTSWEEP {
+
+    void (*setup)(void* const context);     ///< Puts the part and the layer under test back in the same state before each cut
+    void (*workload)(void* const context);  ///< The work the power is cut in
+    void (*check)(void* const context);     ///< Brings the layer back up after the cut and checks what survived
+    void* context;                          ///< Whatever the callbacks share, the layer under test for example
+
+} MX25RTestSweep;
+
+/**
+ * @brief Runs the workload once with the power cut at one point
+ * @note The sweep loop is kept out of here, so no variable that changes after setjmp lives in the frame longjmp comes back to
+ *
+ * @param[in] sweep: What to run
+ * @param[in] cut: How many programs and erases run in full before the one that is cut
+ * @param[in] percent: How much of the cut operation lands
+ */
+static inline void MX25RTestCutOnce(const MX25RTestSweep* const sweep, const uint32_t cut, const uint8_t percent) {
+
+    sweep->setup(sweep->context);
+    MX25REmulatorSchedulePowerCut(cut, percent, MX25RTestCut);
+
+    if(setjmp(mx25r_test_cut_point) == 0) {
+        sweep->workload(sweep->context);
+        MX25REmulatorCancelPowerCut();
+    }
+
+    sweep->check(sweep->context);
+
+}
+
+/**
+ * @brief Cuts the power on every program and erase of the workload in turn, at each of the given points through the operation
+ *
+ * @param[in] sweep: What to run
+ * @param[in] operations: How many programs and erases the workload does when nothing is cut
+ * @param[in] percents: How much of the cut operation lands, the workload runs once for each
+ * @param[in] percent_count: How many percents there are
+ */
+static inline void MX25RTestSweepCuts(const MX25RTestSweep* const sweep, const uint32_t operations, const uint8_t* const percents, const uint8_t percent_count) {
+
+    for(uint32_t cut = 0; cut < operations; cut++)
+        for(uint8_t p = 0; p < percent_count; p++)
+            MX25RTestCutOnce(sweep, cut, percents[p]);
+
+}
+
+/**
+ * @brief Brings the driver up on the emulated part, as the firmware would after a power on
+ *
+ * @param[out] dev: Device to initialize
+ * @return MX25R*: The device, NULL if it failed
+ */
+static inline MX25R* MX25RTestInit(MX25R* const dev) {
+
+    #if defined(DEBUG) && !defined(MX25R_CAPACITY)
+    return MX25RInit(dev, MX25REmulatorGetHAL(), false, (uint8_t)(MX25R_TEST_CAPACITY >> 20));
+    #else
+    return MX25RInit(dev, MX25REmulatorGetHAL(), false);
+    #endif
+
+}
+
+/**
+ * @brief Reports the result, return it from main
+ *
+ * @param[in] name: Name of the test
+ * @return int: 0 if every check passed
+ */
+static inline int MX25RTestResult(const char* const name) {
+
+    printf("%s: %s, %u failed checks\n", name, mx25r_test_failures ? "FAILED" : "passed", mx25r_test_failures);
+    return mx25r_test_failures ? 1 : 0;
+
+}
+
+#endif // include guard
@@ -0,0 +1,198 @@
+/**
+ * @file MX25RTransactionTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that a power loss at any point leaves a transactional region as it was before or after the commit, never a mix
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+#include "MX25RTransaction.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MX25R_TRANSACTION_TEST_FIRST    48      ///< First sector of the region
+#define MX25R_TRANSACTION_TEST_COUNT    7       ///< How many sectors the region has, the journal and five data sectors
+#define MX25R_TRANSACTION_TEST_PAGES    24      ///< How many logical pages the region holds
+#define MX25R_TRANSACTION_TEST_SIZE     (MX25R_TRANSACTION_TEST_PAGES * MX25R_PAGE_SIZE)
+#define MX25R_TRANSACTION_TEST_ADDRESS  ((uint32_t)MX25R_TRANSACTION_TEST_FIRST * MX25R_SECTOR_SIZE)  ///< Where the region starts
+
+static uint8_t committed[MX25R_TRANSACTION_TEST_SIZE];  ///< What the region reads as after the last commit that returned
+static uint8_t staged[MX25R_TRANSACTION_TEST_SIZE];     ///< What it reads as once the running transaction commits
+static bool is_committing;                              ///< If the power went while a commit could have landed
+static uint8_t snapshot[MX25R_TRANSACTION_TEST_COUNT * MX25R_SECTOR_SIZE];  ///< The region as it was before the power cut sweep
+static uint8_t snapshot_committed[MX25R_TRANSACTION_TEST_SIZE];             ///< What it read as before the power cut sweep
+
+/**
+ * @brief Runs transactions that each rewrite a few random pages, enough to wrap the journal and make the region reclaim
+ *
+ * @param[in] region: Region to run them on
+ * @param[in] count: How many transactions to run
+ */
+static void MX25RTransactionTestWorkload(MX25RTransactionRegion* const region, const uint32_t count) {
+
+    for(uint32_t i = 0; i < count; i++) {
+
+        // a reclaim in begin commits a move that reads the same as before, so it counts as part of the commit
+        memcpy(staged, committed, sizeof(staged));
+        is_committing = true;
+
+        MX25R_TEST_CHECK(MX25RTransactionBegin(region));
+
+        const uint8_t writes = (uint8_t)(1 + rand() % 4);
+        for(uint8_t w = 0; w < writes; w++) {
+
+            const uint16_t page = (uint16_t)(rand() % MX25R_TRANSACTION_TEST_PAGES);
+            const uint16_t size = (uint16_t)(1 + rand() % MX25R_PAGE_SIZE);
+            uint8_t* const data = staged + (uint32_t)page * MX25R_PAGE_SIZE;
+
+            for(uint16_t b = 0; b < size; b++)
+                data[b] = (uint8_t)rand();
+
+            memset(data + size, 0xff, MX25R_PAGE_SIZE - size);
+
+            MX25R_TEST_CHECK(MX25RTransactionWrite(region, page, data, size));
+
+        }
+
+        MX25R_TEST_CHECK(MX25RTransactionCommit(region));
+
+        memcpy(committed, staged, sizeof(committed));
+        is_committing = false;
+
+    }
+
+}
+
+/**
+ * @brief Sets up a fresh part, erases are made short since the sweep runs the workload once per cut point
+ */
+static void MX25RTransactionTestPart(void) {
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25REmulatorGetTiming()->sector_erase_ns = 100000;
+
+}
+
+/**
+ * @brief Mounts the region and checks it reads back whole as the last commit, or as the one that was running when the power went
+ *
+ * @param[in] dev: Device the region is on
+ * @param[out] region: Region to mount
+ */
+static void MX25RTransactionTestCheck(MX25R* const dev, MX25RTransactionRegion* const region) {
+
+    static uint8_t contents[MX25R_TRANSACTION_TEST_SIZE];
+
+    MX25R_TEST_CHECK(MX25RTransactionMount(region, dev, MX25R_TRANSACTION_TEST_FIRST, MX25R_TRANSACTION_TEST_COUNT, MX25R_TRANSACTION_TEST_PAGES) != NULL);
+    MX25R_TEST_CHECK(MX25RTransactionRead(region, 0, contents, sizeof(contents)));
+
+    const bool is_before = memcmp(contents, committed, sizeof(contents)) == 0;
+    const bool is_after = is_committing && memcmp(contents, staged, sizeof(contents)) == 0;
+    MX25R_TEST_CHECK(is_before || is_after);
+
+    if(is_after)
+        memcpy(committed, staged, sizeof(committed));
+
+    is_committing = false;
+
+}
+
+/// @brief What the power cut sweep works on
+typedef struct MX25RTRANSACTIONTESTSTATE {
+
+    MX25R* dev;                         ///< Device the region is on
+    MX25RTransactionRegion* region;     ///< Region under test
+
+} MX25RTransactionTestState;
+
+/**
+ * @brief Sweep setup, a fresh part holding the region and the last commit as they were before the sweep
+ *
+ * @param[in] context: The MX25RTransactionTestState
+ */
+static void MX25RTransactionTestSetup(void* const context) {
+
+    MX25RTransactionTestState* const state = (MX25RTransactionTestState*)context;
+
+    MX25RTransactionTestPart();
+    memcpy(MX25REmulatorGetMemory() + MX25R_TRANSACTION_TEST_ADDRESS, snapshot, sizeof(snapshot));
+    memcpy(committed, snapshot_committed, sizeof(committed));
+
+    MX25RTestInit(state->dev);
+    MX25RTransactionMount(state->region, state->dev, MX25R_TRANSACTION_TEST_FIRST, MX25R_TRANSACTION_TEST_COUNT, MX25R_TRANSACTION_TEST_PAGES);
+
+    srand(2);
+
+}
+
+/**
+ * @brief Sweep workload, the same run of transactions that was counted without a cut
+ *
+ * @param[in] context: The MX25RTransactionTestState
+ */
+static void MX25RTransactionTestWorkloadCut(void* const context) { MX25RTransactionTestWorkload(((MX25RTransactionTestState*)context)->region, 40); }
+
+/**
+ * @brief Sweep check, back up after the power loss the region has to hold one commit or the other and keep taking transactions
+ *
+ * @param[in] context: The MX25RTransactionTestState
+ */
+static void MX25RTransactionTestCheckCut(void* const context) {
+
+    MX25RTransactionTestState* const state = (MX25RTransactionTestState*)context;
+
+    MX25RTestInit(state->dev);
+    MX25RTransactionTestCheck(state->dev, state->region);
+
+    srand(3);
+    MX25RTransactionTestWorkload(state->region, 10);
+    MX25RTransactionTestCheck(state->dev, state->region);
+
+}
+
+int main(void) {
+
+    static MX25RTransactionRegion region;
+    MX25R dev;
+
+    MX25RTransactionTestPart();
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+    memset(committed, 0xff, sizeof(committed));
+
+    // a run with no cut, remounting along the way, to fill the region and count the cut points
+    srand(1);
+    for(uint32_t round = 0; round < 8; round++) {
+
+        MX25RTransactionTestCheck(&dev, &region);
+        MX25RTransactionTestWorkload(&region, 10);
+
+    }
+
+    MX25RTransactionTestCheck(&dev, &region);
+
+    memcpy(snapshot, MX25REmulatorGetMemory() + MX25R_TRANSACTION_TEST_ADDRESS, sizeof(snapshot));
+    memcpy(snapshot_committed, committed, sizeof(committed));
+
+    const uint32_t before = MX25REmulatorGetOperationCount();
+    srand(2);
+    MX25RTransactionTestWorkload(&region, 40);
+    const uint32_t operations = MX25REmulatorGetOperationCount() - before;
+
+    // a commit record is shorter than half a page, a cut at 12 percent tears it right after a whole map entry so only its CRC can tell
+    const uint8_t percents[] = { 0, 12, 50, 100 };
+
+    MX25RTransactionTestState state = { &dev, &region };
+    const MX25RTestSweep sweep = { MX25RTransactionTestSetup, MX25RTransactionTestWorkloadCut, MX25RTransactionTestCheckCut, &state };
+
+    MX25RTestSweepCuts(&sweep, operations, percents, sizeof(percents));
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("transaction");
+
+}
@@ -0,0 +1,228 @@
+/**
+ * @file MX25RUpdateTest.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Checks that an update cut by a power loss at any point resumes from its last checkpoint to the exact new image
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RTest.h"
+#include "MX25RUpdate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MX25R_UPDATE_TEST_SOURCE        0                       ///< Address of the current slot
+#define MX25R_UPDATE_TEST_SOURCE_SIZE   (MX25R_BLOCK_SIZE / 2)  ///< How many bytes of the current slot copies read from
+#define MX25R_UPDATE_TEST_BLOCK         2                       ///< First block of the target slot
+#define MX25R_UPDATE_TEST_BLOCKS        2                       ///< How many blocks the target slot has
+#define MX25R_UPDATE_TEST_IMAGE_SIZE    (MX25R_BLOCK_SIZE + MX25R_BLOCK_SIZE / 4)   ///< Size of the new image, it runs into the second block
+#define MX25R_UPDATE_TEST_CHUNK         700                     ///< Most delta bytes handed over at once, as a radio might
+#define MX25R_UPDATE_TEST_CHECKPOINT    8                       ///< How many chunks go by between checkpoints
+
+static uint8_t source[MX25R_UPDATE_TEST_SOURCE_SIZE];  ///< What the current slot holds
+static uint8_t image[MX25R_UPDATE_TEST_IMAGE_SIZE];    ///< The new image the delta builds
+static uint8_t delta[2 * MX25R_UPDATE_TEST_IMAGE_SIZE]; ///< The delta itself
+static uint32_t delta_size;                             ///< How many bytes of the delta there are
+
+static MX25RUpdateCheckpoint saved;                     ///< The last checkpoint, kept where a power loss can't reach it
+static bool has_saved;                                  ///< If a checkpoint was taken yet
+
+/**
+ * @brief Puts a little endian u32 on the end of the delta
+ *
+ * @param[in] value: Value to put
+ */
+static void MX25RUpdateTestPut32(const uint32_t value) {
+
+    for(uint8_t i = 0; i < 4; i++)
+        delta[delta_size++] = (uint8_t)(value >> (8 * i));
+
+}
+
+/**
+ * @brief Builds a new image out of copies from the current slot and inserted bytes, and the delta that makes it
+ */
+static void MX25RUpdateTestMakeDelta(void) {
+
+    for(uint32_t i = 0; i < MX25R_UPDATE_TEST_SOURCE_SIZE; i++)
+        source[i] = (uint8_t)rand();
+
+    for(uint32_t size = 0; size < MX25R_UPDATE_TEST_IMAGE_SIZE;) {
+
+        uint32_t length = 1 + (uint32_t)rand() % 3000;
+        if(length > MX25R_UPDATE_TEST_IMAGE_SIZE - size)
+            length = MX25R_UPDATE_TEST_IMAGE_SIZE - size;
+
+        if(rand() % 2) {
+
+            const uint32_t offset = (uint32_t)rand() % (MX25R_UPDATE_TEST_SOURCE_SIZE - length);
+
+            delta[delta_size++] = MX25R_UPDATE_COPY;
+            MX25RUpdateTestPut32(length);
+            MX25RUpdateTestPut32(offset);
+            memcpy(image + size, source + offset, length);
+
+        }
+        else {
+
+            delta[delta_size++] = MX25R_UPDATE_INSERT;
+            MX25RUpdateTestPut32(length);
+
+            for(uint32_t i = 0; i < length; i++)
+                image[size + i] = delta[delta_size++] = (uint8_t)rand();
+
+        }
+
+        size += length;
+
+    }
+
+}
+
+/**
+ * @brief Sets up a fresh part with the current slot programmed and junk left in the target slot, erases are made short since the sweep runs the update once per cut point
+ */
+static void MX25RUpdateTestPart(void) {
+
+    MX25R_TEST_CHECK(MX25REmulatorInit(MX25R_TEST_CAPACITY, NULL));
+    MX25REmulatorGetTiming()->page_program_ns = 20000;
+    MX25REmulatorGetTiming()->block_erase_ns = 2000000;
+
+    uint8_t* const memory = MX25REmulatorGetMemory();
+    memcpy(memory + MX25R_UPDATE_TEST_SOURCE, source, sizeof(source));
+    memset(memory + (uint32_t)MX25R_UPDATE_TEST_BLOCK * MX25R_BLOCK_SIZE, 0x00, (uint32_t)MX25R_UPDATE_TEST_BLOCKS * MX25R_BLOCK_SIZE);
+
+}
+
+/**
+ * @brief Sends the rest of the delta in uneven chunks, taking a checkpoint every few of them, and finishes the update
+ *
+ * @param[in] update: Update to apply to
+ * @param[in] offset: Where in the delta to start sending from
+ */
+static void MX25RUpdateTestApply(MX25RUpdate* const update, uint32_t offset) {
+
+    for(uint32_t chunk = 1; offset < delta_size; chunk++) {
+
+        uint32_t size = 1 + (uint32_t)rand() % MX25R_UPDATE_TEST_CHUNK;
+        if(size > delta_size - offset)
+            size = delta_size - offset;
+
+        MX25R_TEST_CHECK(MX25RUpdateWrite(update, delta + offset, size));
+        offset += size;
+
+        MX25RUpdateCheckpoint checkpoint;
+        if(chunk % MX25R_UPDATE_TEST_CHECKPOINT == 0 && MX25RUpdateTakeCheckpoint(update, &checkpoint)) {
+            saved = checkpoint;
+            has_saved = true;
+        }
+
+    }
+
+    uint32_t size = 0;
+    MX25R_TEST_CHECK(MX25RUpdateFinish(update, &size));
+    MX25R_TEST_CHECK(size == MX25R_UPDATE_TEST_IMAGE_SIZE);
+
+}
+
+/**
+ * @brief Checks the target slot holds exactly the new image, straight from the emulated array
+ */
+static void MX25RUpdateTestCheck(void) {
+
+    const uint8_t* const target = MX25REmulatorGetMemory() + (uint32_t)MX25R_UPDATE_TEST_BLOCK * MX25R_BLOCK_SIZE;
+    MX25R_TEST_CHECK(memcmp(target, image, MX25R_UPDATE_TEST_IMAGE_SIZE) == 0);
+
+}
+
+/// @brief What the power cut sweep works on
+typedef struct MX25RUPDATETESTSTATE {
+
+    MX25R* dev;             ///< Device the slots are on
+    MX25RUpdate* update;    ///< Update under test
+
+} MX25RUpdateTestState;
+
+/**
+ * @brief Sweep setup, a fresh part with no checkpoint taken yet
+ *
+ * @param[in] context: The MX25RUpdateTestState
+ */
+static void MX25RUpdateTestSetup(void* const context) {
+
+    MX25RUpdateTestPart();
+    MX25RTestInit(((MX25RUpdateTestState*)context)->dev);
+    has_saved = false;
+
+    srand(2);
+
+}
+
+/**
+ * @brief Sweep workload, the same update that was counted without a cut
+ *
+ * @param[in] context: The MX25RUpdateTestState
+ */
+static void MX25RUpdateTestWorkload(void* const context) {
+
+    MX25RUpdateTestState* const state = (MX25RUpdateTestState*)context;
+
+    MX25RUpdateBegin(state->update, state->dev, MX25R_UPDATE_TEST_SOURCE, MX25R_UPDATE_TEST_SOURCE_SIZE, MX25R_UPDATE_TEST_BLOCK, MX25R_UPDATE_TEST_BLOCKS);
+    MX25RUpdateTestApply(state->update, 0);
+
+}
+
+/**
+ * @brief Sweep check, back up after the power loss pick up from the last checkpoint or start over if there was none
+ *
+ * @param[in] context: The MX25RUpdateTestState
+ */
+static void MX25RUpdateTestResume(void* const context) {
+
+    MX25RUpdateTestState* const state = (MX25RUpdateTestState*)context;
+
+    MX25RTestInit(state->dev);
+
+    if(has_saved)
+        MX25R_TEST_CHECK(MX25RUpdateResume(state->update, state->dev, MX25R_UPDATE_TEST_SOURCE, MX25R_UPDATE_TEST_SOURCE_SIZE, MX25R_UPDATE_TEST_BLOCK, MX25R_UPDATE_TEST_BLOCKS, &saved) != NULL);
+    else
+        MX25R_TEST_CHECK(MX25RUpdateBegin(state->update, state->dev, MX25R_UPDATE_TEST_SOURCE, MX25R_UPDATE_TEST_SOURCE_SIZE, MX25R_UPDATE_TEST_BLOCK, MX25R_UPDATE_TEST_BLOCKS) != NULL);
+
+    MX25RUpdateTestApply(state->update, has_saved ? saved.delta_offset : 0);
+    MX25RUpdateTestCheck();
+
+}
+
+int main(void) {
+
+    static MX25RUpdate update;
+    MX25R dev;
+
+    srand(1);
+    MX25RUpdateTestMakeDelta();
+
+    // a run with no cut, to count the cut points
+    MX25RUpdateTestPart();
+    MX25R_TEST_CHECK(MX25RTestInit(&dev) != NULL);
+
+    srand(2);
+    MX25R_TEST_CHECK(MX25RUpdateBegin(&update, &dev, MX25R_UPDATE_TEST_SOURCE, MX25R_UPDATE_TEST_SOURCE_SIZE, MX25R_UPDATE_TEST_BLOCK, MX25R_UPDATE_TEST_BLOCKS) != NULL);
+    MX25RUpdateTestApply(&update, 0);
+    MX25RUpdateTestCheck();
+
+    // a power cut anywhere in the update resumes from the last checkpoint, or starts over, to the exact new image
+    MX25RUpdateTestState state = { &dev, &update };
+    const MX25RTestSweep sweep = { MX25RUpdateTestSetup, MX25RUpdateTestWorkload, MX25RUpdateTestResume, &state };
+    const uint8_t percents[] = { 0, 50, 100 };
+
+    MX25RTestSweepCuts(&sweep, MX25REmulatorGetOperationCount(), percents, sizeof(percents));
+
+    MX25REmulatorDeinit();
+
+    return MX25RTestResult("update");
+
+}
@@ -0,0 +1,503 @@
+/**
+ * @file MX25RBench.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Reproducible benchmark of the driver against the emulated part, reports throughput and driver overhead as CSV
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Throughput and erase numbers are measured in emulated time, so they only depend on the driver and the timing model
+ * and come out the same on every run. Each command runs at the fastest clock it allows, capped at the bus clock given with -f.
+ * CPU overhead is measured against a bus that does nothing, so it is only the driver.
+ *
+ *      mx25r-bench [-f bus clock hz] > results.csv
+ *      mx25r-bench --compare old.csv new.csv [threshold percent]
+ */
+
+#include "MX25R.h"
+#include "MX25REmulator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MX25R_BENCH_HAS_TSC     1   ///< The time stamp counter ticks at a fixed reference rate, not with the core clock, so it counts ticks rather than cycles
+#endif
+
+#ifdef MX25R_CAPACITY
+#define MX25R_BENCH_CAPACITY        MX25R_CAPACITY  ///< Emulated part size, the part the driver is built for
+#else
+#define MX25R_BENCH_CAPACITY        (1ul << 21)     ///< Emulated part size, an MX25R1635F
+#endif
+#define MX25R_BENCH_SEQUENTIAL_SIZE (1ul << 20)     ///< How much a sequential read test reads
+#define MX25R_BENCH_RANDOM_READS    4096            ///< How many reads a random read test does
+#define MX25R_BENCH_PROGRAM_PAGES   256             ///< How many pages the page program test programs
+#define MX25R_BENCH_ERASE_RANGE     (1ul << 18)     ///< How much the erase range tests erase
+#define MX25R_BENCH_OVERHEAD_CALLS  200000          ///< How many calls each overhead test times
+#define MX25R_BENCH_MAX_METRICS     128             ///< Most metrics a results file can hold when comparing
+
+/// @brief What the counting HAL saw
+typedef struct MX25RBENCHCOUNTERS {
+
+    uint64_t hal_calls;     ///< Calls into any HAL function
+    uint64_t bytes_written; ///< Bytes passed to spi_write
+    uint64_t bytes_read;    ///< Bytes passed to spi_read
+
+} MX25RBenchCounters;
+
+/// @brief A driver call the overhead tests time
+typedef struct MX25RBENCHOPERATION {
+
+    const char* name;       ///< Metric name
+    uint32_t payload;       ///< How many of the bus bytes are data rather than command
+    uint8_t (*run)(MX25R* const dev, uint8_t* const buffer);   ///< Makes the call
+
+} MX25RBenchOperation;
+
+/// @brief One metric from a results file
+typedef struct MX25RBENCHMETRIC {
+
+    char name[64];          ///< Metric name
+    double value;           ///< Metric value
+    char unit[16];          ///< Unit, decides if higher or lower is better
+
+} MX25RBenchMetric;
+
+static const MX25RHAL* inner_hal = NULL;    ///< Where the counting HAL sends calls, NULL for a bus that does nothing
+static uint32_t bus_hz;                     ///< Fastest clock the host drives the bus at
+static MX25RBenchCounters counters;         ///< What the counting HAL saw
+static uint32_t random_state = 0x2545f491;  ///< Fixed seed so every run reads the same addresses
+
+/**
+ * @brief Counts a write and passes it on
+ *
+ * @param[in] data: Bytes to write
+ * @param[in] size: How many bytes
+ * @return uint32_t: How many bytes were written
+ */
+static uint32_t MX25RBenchWrite(const void* const data, const uint32_t size) {
+
+    counters.hal_calls++;
+    counters.bytes_written += size;
+    return inner_hal ? inner_hal->spi_write(data, size) : size;
+
+}
+
+/**
+ * @brief Counts a read and passes it on
+ *
+ * @param[out] data: Where to read to
+ * @param[in] size: How many bytes
+ * @return uint32_t: How many bytes were read
+ */
+static uint32_t MX25RBenchRead(void* const data, const uint32_t size) {
+
+    counters.hal_calls++;
+    counters.bytes_read += size;
+
+    if(inner_hal)
+        return inner_hal->spi_read(data, size);
+
+    // a bus with nothing on it, status reads come back idle
+    memset(data, 0, size);
+    return size;
+
+}
+
+/**
+ * @brief Counts a chip select and passes it on
+ *
+ * @param[in] is_selected: If CS is pulled low
+ */
+static void MX25RBenchSelect(const bool is_selected) {
+
+    counters.hal_calls++;
+    if(inner_hal)
+        inner_hal->select_chip(is_selected);
+
+}
+
+/**
+ * @brief Gets the next number from a fixed xorshift sequence
+ *
+ * @return uint32_t: A pseudo random number
+ */
+static uint32_t MX25RBenchRandom(void) {
+
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+
+}
+
+/**
+ * @brief Gets the host's monotonic time
+ *
+ * @return uint64_t: Time in nanoseconds
+ */
+static uint64_t MX25RBenchHostNs(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+
+}
+
+/**
+ * @brief Prints one result line
+ *
+ * @param[in] name: Metric name
+ * @param[in] value: Metric value
+ * @param[in] unit: Unit of the value
+ */
+static void MX25RBenchEmit(const char* const name, const double value, const char* const unit) { printf("%s,%.3f,%s\n", name, value, unit); }
+
+/**
+ * @brief Clocks the bus as fast as the host and the command both allow
+ *
+ * @param[in] max_hz: Fastest clock the command works at
+ * @return uint32_t: The clock the bus runs at
+ */
+static uint32_t MX25RBenchClock(const uint32_t max_hz) {
+
+    MX25REmulatorGetTiming()->spi_hz = bus_hz < max_hz ? bus_hz : max_hz;
+    return MX25REmulatorGetTiming()->spi_hz;
+
+}
+
+/**
+ * @brief Waits for the emulated part to finish a program or erase
+ *
+ * @param[in] dev: Device to wait on
+ */
+static void MX25RBenchWait(MX25R* const dev) { while(MX25RIsWriteInProgress(dev)); }
+
+/**
+ * @brief Measures sequential and random read throughput for one read command
+ *
+ * @param[in] dev: Device to read from
+ * @param[in] mode: Name of the read mode for the metric names
+ * @param[in] read: The driver's read function for that mode
+ * @param[in] max_hz: Fastest clock that read command works at
+ */
+static void MX25RBenchReads(MX25R* const dev, const char* const mode, uint8_t (*read)(const MX25R* const, const uint32_t, uint8_t* const, const uint32_t), const uint32_t max_hz) {
+
+    static uint8_t buffer[MX25R_SECTOR_SIZE];
+    const uint32_t chunks[] = { MX25R_PAGE_SIZE, MX25R_SECTOR_SIZE };
+    char name[64];
+
+    snprintf(name, sizeof(name), "config.%s.spi_clock", mode);
+    MX25RBenchEmit(name, (double)MX25RBenchClock(max_hz) / 1e6, "MHz");
+
+    for(uint8_t i = 0; i < 2; i++) {
+
+        const uint64_t start = MX25REmulatorGetTimeNs();
+        for(uint32_t address = 0; address < MX25R_BENCH_SEQUENTIAL_SIZE; address += chunks[i])
+            read(dev, address, buffer, chunks[i]);
+
+        const double seconds = (double)(MX25REmulatorGetTimeNs() - start) / 1e9;
+
+        snprintf(name, sizeof(name), "read.%s.sequential.%u", mode, chunks[i]);
+        MX25RBenchEmit(name, (double)MX25R_BENCH_SEQUENTIAL_SIZE / 1024.0 / seconds, "KB/s");
+
+    }
+
+    for(uint8_t i = 0; i < 2; i++) {
+
+        const uint32_t size = i == 0 ? 16 : MX25R_PAGE_SIZE;
+
+        const uint64_t start = MX25REmulatorGetTimeNs();
+        for(uint32_t n = 0; n < MX25R_BENCH_RANDOM_READS; n++)
+            read(dev, MX25RBenchRandom() % (MX25R_BENCH_CAPACITY - size), buffer, size);
+
+        const double seconds = (double)(MX25REmulatorGetTimeNs() - start) / 1e9;
+
+        snprintf(name, sizeof(name), "read.%s.random.%u", mode, size);
+        MX25RBenchEmit(name, (double)size * MX25R_BENCH_RANDOM_READS / 1024.0 / seconds, "KB/s");
+
+        snprintf(name, sizeof(name), "read.%s.random.%u.latency", mode, size);
+        MX25RBenchEmit(name, seconds * 1e6 / MX25R_BENCH_RANDOM_READS, "us");
+
+    }
+
+}
+
+/**
+ * @brief Measures page program throughput including waiting for each page to land
+ *
+ * @param[in] dev: Device to program
+ */
+static void MX25RBenchProgram(MX25R* const dev) {
+
+    static uint8_t page[MX25R_PAGE_SIZE];
+    for(uint16_t i = 0; i < MX25R_PAGE_SIZE; i++)
+        page[i] = (uint8_t)MX25RBenchRandom();
+
+    for(MX25RBlock block = 0; block < MX25R_BENCH_PROGRAM_PAGES * MX25R_PAGE_SIZE / MX25R_BLOCK_SIZE; block++) {
+        MX25REnableWriting(dev);
+        MX25REraseBlock(dev, block);
+        MX25RBenchWait(dev);
+    }
+
+    const uint64_t start = MX25REmulatorGetTimeNs();
+    for(MX25RPage n = 0; n < MX25R_BENCH_PROGRAM_PAGES; n++) {
+        MX25REnableWriting(dev);
+        MX25RPageProgram(dev, n, page, MX25R_PAGE_SIZE);
+        MX25RBenchWait(dev);
+    }
+
+    const double seconds = (double)(MX25REmulatorGetTimeNs() - start) / 1e9;
+    MX25RBenchEmit("program.page.throughput", (double)MX25R_BENCH_PROGRAM_PAGES * MX25R_PAGE_SIZE / 1024.0 / seconds, "KB/s");
+    MX25RBenchEmit("program.page.latency", seconds * 1e6 / MX25R_BENCH_PROGRAM_PAGES, "us");
+
+}
+
+/**
+ * @brief Measures how long erasing a range takes with each erase size
+ *
+ * @param[in] dev: Device to erase
+ */
+static void MX25RBenchErase(MX25R* const dev) {
+
+    const uint32_t sizes[] = { MX25R_SECTOR_SIZE, MX25R_SMALL_BLOCK_SIZE, MX25R_BLOCK_SIZE };
+    const char* const names[] = { "erase.range.sector", "erase.range.block32k", "erase.range.block" };
+
+    for(uint8_t i = 0; i < 3; i++) {
+
+        const uint64_t start = MX25REmulatorGetTimeNs();
+
+        for(uint32_t unit = 0; unit < MX25R_BENCH_ERASE_RANGE / sizes[i]; unit++) {
+
+            MX25REnableWriting(dev);
+
+            if(i == 0)
+                MX25REraseSector(dev, (MX25RSector)unit);
+            else if(i == 1)
+                MX25REraseBlock32K(dev, (MX25RSmallBlock)unit);
+            else
+                MX25REraseBlock(dev, (MX25RBlock)unit);
+
+            MX25RBenchWait(dev);
+
+        }
+
+        MX25RBenchEmit(names[i], (double)(MX25REmulatorGetTimeNs() - start) / 1e6, "ms");
+
+    }
+
+}
+
+static uint8_t MX25RBenchOpRead(MX25R* const dev, uint8_t* const buffer) { return MX25RRead(dev, 0x1000, buffer, 16); }
+static uint8_t MX25RBenchOpFastRead(MX25R* const dev, uint8_t* const buffer) { return MX25RFastRead(dev, 0x1000, buffer, 16); }
+// the part drops write enable after every program and erase, so these time the write enable along with them as the driver's callers have to
+static uint8_t MX25RBenchOpPageProgram(MX25R* const dev, uint8_t* const buffer) { return MX25REnableWriting(dev) && MX25RPageProgram(dev, 16, buffer, MX25R_PAGE_SIZE); }
+static uint8_t MX25RBenchOpEraseSector(MX25R* const dev, uint8_t* const buffer) { (void)buffer; return MX25REnableWriting(dev) && MX25REraseSector(dev, 1); }
+static uint8_t MX25RBenchOpReadStatus(MX25R* const dev, uint8_t* const buffer) { (void)buffer; MX25RStatus status; return MX25RReadStatus(dev, &status); }
+static uint8_t MX25RBenchOpIsWriteInProgress(MX25R* const dev, uint8_t* const buffer) { (void)buffer; return MX25RIsWriteInProgress(dev); }
+static uint8_t MX25RBenchOpVerifyErase(MX25R* const dev, uint8_t* const buffer) { (void)buffer; return MX25RVerifyErase(dev); }
+static uint8_t MX25RBenchOpSetLowPowerMode(MX25R* const dev, uint8_t* const buffer) { (void)buffer; return MX25RSetLowPowerMode(dev, true); }
+
+/**
+ * @brief Measures what each driver call costs on its own, CPU time, HAL calls and command bytes on the bus, all averaged over the same calls
+ *
+ * @param[in] dev: Device set up on the counting HAL with nothing behind it
+ */
+static void MX25RBenchOverhead(MX25R* const dev) {
+
+    static const MX25RBenchOperation operations[] = {
+        { "read",               16,                 MX25RBenchOpRead },
+        { "fast_read",          16,                 MX25RBenchOpFastRead },
+        { "write_enable.page_program", MX25R_PAGE_SIZE, MX25RBenchOpPageProgram },
+        { "write_enable.erase_sector", 0,           MX25RBenchOpEraseSector },
+        { "read_status",        1,                  MX25RBenchOpReadStatus },
+        { "is_write_in_progress", 1,                MX25RBenchOpIsWriteInProgress },
+        { "verify_erase",       1,                  MX25RBenchOpVerifyErase },
+        { "set_low_power_mode", 0,                  MX25RBenchOpSetLowPowerMode },
+    };
+
+    static uint8_t buffer[MX25R_PAGE_SIZE];
+    char name[64];
+
+    for(size_t i = 0; i < sizeof(operations) / sizeof(operations[0]); i++) {
+
+        const MX25RBenchOperation* const op = operations + i;
+
+        // one call first so state the driver builds up once, such as a register shadow, is not counted
+        op->run(dev, buffer);
+        memset(&counters, 0, sizeof(counters));
+
+        #ifdef MX25R_BENCH_HAS_TSC
+        const uint64_t start_ticks = __rdtsc();
+        #endif
+        const uint64_t start_ns = MX25RBenchHostNs();
+
+        for(uint32_t n = 0; n < MX25R_BENCH_OVERHEAD_CALLS; n++)
+            op->run(dev, buffer);
+
+        const double ns = (double)(MX25RBenchHostNs() - start_ns) / MX25R_BENCH_OVERHEAD_CALLS;
+
+        #ifdef MX25R_BENCH_HAS_TSC
+        const double ticks = (double)(__rdtsc() - start_ticks) / MX25R_BENCH_OVERHEAD_CALLS;
+        #endif
+
+        snprintf(name, sizeof(name), "overhead.%s.time", op->name);
+        MX25RBenchEmit(name, ns, "ns/call");
+
+        #ifdef MX25R_BENCH_HAS_TSC
+        snprintf(name, sizeof(name), "overhead.%s.tsc_ticks", op->name);
+        MX25RBenchEmit(name, ticks, "ticks/call");
+        #endif
+
+        snprintf(name, sizeof(name), "overhead.%s.hal_calls", op->name);
+        MX25RBenchEmit(name, (double)counters.hal_calls / MX25R_BENCH_OVERHEAD_CALLS, "calls/op");
+
+        // a call answered from the register shadows moves no payload either
+        const double moved = (double)(counters.bytes_written + counters.bytes_read) / MX25R_BENCH_OVERHEAD_CALLS;
+
+        snprintf(name, sizeof(name), "overhead.%s.command_bytes", op->name);
+        MX25RBenchEmit(name, moved > op->payload ? moved - op->payload : 0, "bytes/op");
+
+    }
+
+}
+
+/**
+ * @brief Loads the metrics from a results file
+ *
+ * @param[in] path: File to load
+ * @param[out] metrics: Where to put the metrics
+ * @return uint32_t: How many metrics were loaded, 0 if the file could not be read
+ */
+static uint32_t MX25RBenchLoad(const char* const path, MX25RBenchMetric* const metrics) {
+
+    FILE* const file = fopen(path, "r");
+    if(file == NULL) {
+        fprintf(stderr, "can't open %s\n", path);
+        return 0;
+    }
+
+    uint32_t count = 0;
+    char line[128];
+
+    while(count < MX25R_BENCH_MAX_METRICS && fgets(line, sizeof(line), file) != NULL) {
+
+        MX25RBenchMetric* const metric = metrics + count;
+        if(sscanf(line, "%63[^,],%lf,%15s", metric->name, &metric->value, metric->unit) == 3)
+            count++;
+
+    }
+
+    fclose(file);
+
+    return count;
+
+}
+
+/**
+ * @brief Compares two results files and prints how every metric moved
+ *
+ * @param[in] old_path: Baseline results
+ * @param[in] new_path: Results to check
+ * @param[in] threshold: How many percent worse a metric may get before it counts as a regression
+ * @return int: Exit code, 1 if anything regressed
+ */
+static int MX25RBenchCompare(const char* const old_path, const char* const new_path, const double threshold) {
+
+    static MX25RBenchMetric old_metrics[MX25R_BENCH_MAX_METRICS], new_metrics[MX25R_BENCH_MAX_METRICS];
+
+    const uint32_t old_count = MX25RBenchLoad(old_path, old_metrics);
+    const uint32_t new_count = MX25RBenchLoad(new_path, new_metrics);
+    if(old_count == 0 || new_count == 0)
+        return 2;
+
+    uint32_t regressions = 0;
+
+    for(uint32_t i = 0; i < new_count; i++) {
+
+        const MX25RBenchMetric* const now = new_metrics + i;
+        const MX25RBenchMetric* before = NULL;
+
+        for(uint32_t j = 0; j < old_count && before == NULL; j++)
+            if(strcmp(old_metrics[j].name, now->name) == 0)
+                before = old_metrics + j;
+
+        // settings are printed so a changed setup is obvious but they are not results
+        if(before == NULL || before->value == 0 || strncmp(now->name, "config.", 7) == 0) {
+            printf("%-48s %12.3f %-12s%s\n", now->name, now->value, now->unit, before == NULL ? " (new)" : "");
+            continue;
+        }
+
+        // throughput is the only thing where more is better
+        const bool is_higher_better = strstr(now->unit, "/s") != NULL;
+        const double change = (now->value - before->value) / before->value * 100.0;
+        const bool is_regression = is_higher_better ? change < -threshold : change > threshold;
+
+        printf("%-48s %12.3f %-12s %+7.1f%%%s\n", now->name, now->value, now->unit, change, is_regression ? "  REGRESSION" : "");
+        regressions += is_regression;
+
+    }
+
+    printf("%u regressions over %.1f%%\n", regressions, threshold);
+
+    return regressions != 0;
+
+}
+
+int main(int argc, char** argv) {
+
+    if(argc >= 4 && strcmp(argv[1], "--compare") == 0)
+        return MX25RBenchCompare(argv[2], argv[3], argc >= 5 ? strtod(argv[4], NULL) : 5.0);
+
+    if(argc == 3 && strcmp(argv[1], "-f") == 0)
+        bus_hz = (uint32_t)strtoul(argv[2], NULL, 0);
+    else if(argc != 1) {
+        fprintf(stderr, "usage: %s [-f bus clock hz] | --compare old.csv new.csv [threshold percent]\n", argv[0]);
+        return 2;
+    }
+
+    if(MX25REmulatorInit(MX25R_BENCH_CAPACITY, NULL) == 0)
+        return 1;
+
+    // by default the bus is as fast as the fastest command, so every command runs at its own limit
+    const MX25REmulatorTiming timing = *MX25REmulatorGetTiming();
+    if(bus_hz == 0)
+        bus_hz = timing.max_hz;
+
+    static const MX25RHAL counting_hal = { MX25RBenchWrite, MX25RBenchRead, MX25RBenchSelect };
+
+    MX25R dev;
+    inner_hal = MX25REmulatorGetHAL();
+    #if defined(DEBUG) && !defined(MX25R_CAPACITY)
+    if(MX25RInit(&dev, &counting_hal, false, (uint8_t)(MX25R_BENCH_CAPACITY >> 20)) == NULL)
+        return 1;
+    #else
+    if(MX25RInit(&dev, &counting_hal, false) == NULL)
+        return 1;
+    #endif
+
+    printf("metric,value,unit\n");
+    MX25RBenchEmit("config.spi_clock", (double)MX25RBenchClock(timing.max_hz) / 1e6, "MHz");
+
+    MX25RBenchProgram(&dev);
+    MX25RBenchReads(&dev, "read", MX25RRead, timing.read_max_hz);
+    MX25RBenchReads(&dev, "fast_read", MX25RFastRead, timing.max_hz);
+
+    MX25RBenchClock(timing.max_hz);
+    MX25RBenchErase(&dev);
+
+    // the overhead tests run against an empty bus so only the driver's own time is counted
+    inner_hal = NULL;
+    MX25RBenchOverhead(&dev);
+
+    MX25REmulatorDeinit();
+
+    return 0;
+
+}
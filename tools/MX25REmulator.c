@@ -0,0 +1,580 @@
+/**
+ * @file MX25REmulator.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of a Host Side Emulated MX25R that plugs in as the HAL
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25REmulator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MX25R_EMU_WIP           (1 << 0)    ///< Write in progress bit of the status register
+#define MX25R_EMU_WEL           (1 << 1)    ///< Write enable latch bit of the status register
+#define MX25R_EMU_STATUS_WRITABLE 0xfc      ///< Status register bits that a write status register can change
+
+#define MX25R_EMU_OTP_LOCKED    (1 << 1)    ///< Security register bit set by locking the OTP region
+#define MX25R_EMU_PROG_SUSPEND  (1 << 2)    ///< Security register bit set while a program is suspended
+#define MX25R_EMU_ERASE_SUSPEND (1 << 3)    ///< Security register bit set while an erase is suspended
+#define MX25R_EMU_PROG_FAIL     (1 << 5)    ///< Security register bit set if the last program failed
+#define MX25R_EMU_ERASE_FAIL    (1 << 6)    ///< Security register bit set if the last erase failed
+
+#define MX25R_EMU_OTP_SIZE      1024        ///< The OTP region is 8K bits
+#define MX25R_EMU_HEADER_SIZE   5           ///< Command, three address bytes and a dummy byte
+
+/// @brief Which kind of operation is keeping the emulated part busy
+typedef enum MX25REMUOPERATION {
+
+    MX25R_EMU_IDLE,
+    MX25R_EMU_PROGRAMMING,
+    MX25R_EMU_ERASING,
+    MX25R_EMU_OTHER
+
+} MX25REmuOperation;
+
+/// @brief Everything about the emulated part
+static struct {
+
+    uint8_t* memory;                        ///< The flash array
+    uint32_t capacity;                      ///< How many bytes are in the flash array
+    uint8_t otp[MX25R_EMU_OTP_SIZE];        ///< The OTP region
+    MX25REmulatorTiming timing;             ///< How long things take
+
+    uint64_t now_ns;                        ///< Emulated time
+    uint64_t busy_until_ns;                 ///< When the running operation finishes
+    uint64_t suspended_remaining_ns;        ///< How much of a suspended operation is left
+    uint64_t awake_at_ns;                   ///< When the part is out of deep sleep
+    MX25REmuOperation operation;            ///< What is running
+    MX25REmuOperation suspended;            ///< What is suspended
+
+    uint8_t status;                         ///< Status register
+    uint8_t config[2];                      ///< Configuration register
+    uint8_t security;                       ///< Security register
+    bool is_sleeping;                       ///< If the part is in deep sleep
+    bool is_in_otp;                         ///< If reads and programs go to the OTP region
+    bool is_reset_enabled;                  ///< If the last command was a reset enable
+
+    bool is_ignored;                        ///< If the part is ignoring the current transaction because it is asleep, waking up or the command was clocked too fast
+    uint8_t header[MX25R_EMU_HEADER_SIZE];  ///< Command and address bytes of the current transaction
+    uint8_t header_size;                    ///< How many header bytes have been clocked in
+    uint8_t page[MX25R_PAGE_SIZE];          ///< Page program data, wraps around like the real page buffer
+    bool page_written[MX25R_PAGE_SIZE];     ///< Which bytes of the page buffer were clocked in
+    uint32_t data_count;                    ///< How many data bytes have been clocked in or out
+
+    uint32_t transaction_count;             ///< How many times CS was pulled low since init
+    uint64_t read_bytes;                    ///< How many bytes were clocked out since init
+    uint32_t operation_count;               ///< How many programs and erases have started since init
+    uint32_t cut_at;                        ///< Program or erase the power is cut on, only valid if cut is set
+    uint8_t cut_percent;                    ///< How much of that operation lands before the power goes
+    void (*cut)(void);                      ///< Called once the power is cut, NULL if no cut is scheduled
+
+} emu;
+
+/**
+ * @brief Moves emulated time forward by a number of bytes on the bus, and finishes whatever operation is due
+ *
+ * @param[in] bytes: How many bytes were clocked
+ */
+static void MX25REmulatorAdvance(const uint32_t bytes) {
+
+    emu.now_ns += (uint64_t)bytes * 8 * 1000000000ull / emu.timing.spi_hz;
+
+    if(emu.operation != MX25R_EMU_IDLE && emu.now_ns >= emu.busy_until_ns) {
+
+        emu.operation = MX25R_EMU_IDLE;
+        emu.status &= (uint8_t)~(MX25R_EMU_WIP | MX25R_EMU_WEL);
+
+    }
+
+}
+
+/**
+ * @brief Starts an operation that keeps WIP set for a while
+ *
+ * @param[in] operation: What is running
+ * @param[in] duration_ns: How long it runs
+ */
+static void MX25REmulatorBusy(const MX25REmuOperation operation, const uint64_t duration_ns) {
+
+    emu.operation = operation;
+    emu.busy_until_ns = emu.now_ns + duration_ns;
+    emu.status |= MX25R_EMU_WIP;
+
+}
+
+/**
+ * @brief Checks if the power is cut on the program or erase that is starting, counting it either way
+ *
+ * @return true: If this operation is the one that gets cut
+ * @return false: If it runs in full
+ */
+static bool MX25REmulatorIsCut(void) { return emu.operation_count++ == emu.cut_at && emu.cut != NULL; }
+
+/**
+ * @brief Drops the power, the part comes back up in its power on state and the scheduled callback is told
+ */
+static void MX25REmulatorPowerLoss(void) {
+
+    emu.operation = MX25R_EMU_IDLE;
+    emu.suspended = MX25R_EMU_IDLE;
+    emu.status &= (uint8_t)~(MX25R_EMU_WIP | MX25R_EMU_WEL);
+    emu.security &= (uint8_t)~(MX25R_EMU_ERASE_SUSPEND | MX25R_EMU_PROG_SUSPEND);
+    emu.config[0] = emu.config[1] = 0;
+    emu.is_sleeping = false;
+    emu.is_in_otp = false;
+    emu.is_reset_enabled = false;
+
+    void (*const cut)(void) = emu.cut;
+    emu.cut = NULL;
+    cut();
+
+}
+
+/**
+ * @brief Gets the address clocked in after the command
+ *
+ * @return uint32_t: The address, wrapped to the size of the part
+ */
+static uint32_t MX25REmulatorAddress(void) { return (((uint32_t)emu.header[1] << 16) | ((uint32_t)emu.header[2] << 8) | emu.header[3]) & (emu.capacity - 1); }
+
+/**
+ * @brief Erases part of the array, if the write enable latch is set
+ *
+ * @param[in] size: How many bytes the erase covers, the address is aligned down to it
+ * @param[in] duration_ns: How long the erase keeps WIP set
+ */
+static void MX25REmulatorErase(const uint32_t size, const uint64_t duration_ns) {
+
+    if(!(emu.status & MX25R_EMU_WEL) || emu.header_size < 4 || (emu.security & (MX25R_EMU_ERASE_SUSPEND | MX25R_EMU_PROG_SUSPEND)))
+        return;
+
+    // a cut erase leaves the start of the range erased and the rest as it was
+    if(MX25REmulatorIsCut()) {
+        memset(emu.memory + (MX25REmulatorAddress() & ~(size - 1)), 0xff, (uint32_t)((uint64_t)size * emu.cut_percent / 100));
+        MX25REmulatorPowerLoss();
+        return;
+    }
+
+    memset(emu.memory + (MX25REmulatorAddress() & ~(size - 1)), 0xff, size);
+
+    emu.security &= (uint8_t)~MX25R_EMU_ERASE_FAIL;
+    MX25REmulatorBusy(MX25R_EMU_ERASING, duration_ns);
+
+}
+
+/**
+ * @brief Runs whatever command was clocked in once CS goes high
+ */
+static void MX25REmulatorExecute(void) {
+
+    const uint8_t command = emu.header[0];
+
+    if(command != MX25R_RESET)
+        emu.is_reset_enabled = false;
+
+    switch(command) {
+
+        case MX25R_WRITE_EN: emu.status |= MX25R_EMU_WEL; break;
+        case MX25R_WRITE_DIS: emu.status &= (uint8_t)~MX25R_EMU_WEL; break;
+
+        case MX25R_PAGE_PROG: {
+
+            if(!(emu.status & MX25R_EMU_WEL) || emu.header_size < 4 || emu.data_count == 0)
+                break;
+
+            const uint32_t base = MX25REmulatorAddress() & ~(uint32_t)(MX25R_PAGE_SIZE - 1);
+            uint8_t* const target = emu.is_in_otp ? emu.otp + (base % MX25R_EMU_OTP_SIZE) : emu.memory + base;
+
+            // a cut program only gets through the start of the page
+            const bool is_cut = MX25REmulatorIsCut();
+            const uint16_t landed = is_cut ? (uint16_t)(MX25R_PAGE_SIZE * emu.cut_percent / 100) : MX25R_PAGE_SIZE;
+
+            // programming can only clear bits, just like the real array
+            for(uint16_t i = 0; i < landed; i++)
+                if(emu.page_written[i])
+                    target[i] &= emu.page[i];
+
+            if(is_cut) {
+                MX25REmulatorPowerLoss();
+                break;
+            }
+
+            emu.security &= (uint8_t)~MX25R_EMU_PROG_FAIL;
+            MX25REmulatorBusy(MX25R_EMU_PROGRAMMING, emu.timing.page_program_ns);
+            break;
+
+        }
+
+        case MX25R_SECT_ERASE: MX25REmulatorErase(MX25R_SECTOR_SIZE, emu.timing.sector_erase_ns); break;
+        case MX25R_BLOCK_ERASE32K: MX25REmulatorErase(MX25R_SMALL_BLOCK_SIZE, emu.timing.block_erase32_ns); break;
+        case MX25R_BLOCK_ERASE: MX25REmulatorErase(MX25R_BLOCK_SIZE, emu.timing.block_erase_ns); break;
+
+        case MX25R_CHIP_ERASE:
+        case MX25R_FLASH_ERASE:
+
+            if(!(emu.status & MX25R_EMU_WEL))
+                break;
+
+            if(MX25REmulatorIsCut()) {
+                memset(emu.memory, 0xff, (uint32_t)((uint64_t)emu.capacity * emu.cut_percent / 100));
+                MX25REmulatorPowerLoss();
+                break;
+            }
+
+            memset(emu.memory, 0xff, emu.capacity);
+            MX25REmulatorBusy(MX25R_EMU_ERASING, (uint64_t)emu.timing.chip_erase_ms * 1000000ull);
+            break;
+
+        case MX25R_WRITE_STAT_REG:
+
+            if(!(emu.status & MX25R_EMU_WEL) || emu.header_size < 2)
+                break;
+
+            emu.status = (uint8_t)((emu.status & ~MX25R_EMU_STATUS_WRITABLE) | (emu.header[1] & MX25R_EMU_STATUS_WRITABLE));
+            if(emu.header_size > 2)
+                emu.config[0] = emu.header[2];
+            if(emu.header_size > 3)
+                emu.config[1] = emu.header[3];
+
+            MX25REmulatorBusy(MX25R_EMU_OTHER, 0);
+            break;
+
+        case MX25R_WRITE_SEC_REG:
+
+            if(emu.status & MX25R_EMU_WEL)
+                emu.security |= MX25R_EMU_OTP_LOCKED;
+            break;
+
+        case MX25R_SUSPEND:
+
+            if(emu.operation != MX25R_EMU_PROGRAMMING && emu.operation != MX25R_EMU_ERASING)
+                break;
+
+            emu.suspended = emu.operation;
+            emu.suspended_remaining_ns = emu.busy_until_ns - emu.now_ns;
+            emu.security |= emu.operation == MX25R_EMU_ERASING ? MX25R_EMU_ERASE_SUSPEND : MX25R_EMU_PROG_SUSPEND;
+            MX25REmulatorBusy(MX25R_EMU_OTHER, emu.timing.suspend_ns);
+            break;
+
+        case MX25R_RESUME:
+
+            if(emu.suspended == MX25R_EMU_IDLE || emu.operation != MX25R_EMU_IDLE)
+                break;
+
+            emu.security &= (uint8_t)~(MX25R_EMU_ERASE_SUSPEND | MX25R_EMU_PROG_SUSPEND);
+            MX25REmulatorBusy(emu.suspended, emu.suspended_remaining_ns);
+            emu.suspended = MX25R_EMU_IDLE;
+            break;
+
+        case MX25R_DEEP_SLEEP: emu.is_sleeping = true; break;
+        case MX25R_ENTER_OTP: emu.is_in_otp = true; break;
+        case MX25R_EXIT_OTP: emu.is_in_otp = false; break;
+        case MX25R_RESET_EN: emu.is_reset_enabled = true; break;
+
+        case MX25R_RESET:
+
+            if(!emu.is_reset_enabled)
+                break;
+
+            emu.is_reset_enabled = false;
+            emu.is_in_otp = false;
+            emu.operation = MX25R_EMU_IDLE;
+            emu.suspended = MX25R_EMU_IDLE;
+            emu.status &= (uint8_t)~(MX25R_EMU_WIP | MX25R_EMU_WEL);
+            emu.security &= (uint8_t)~(MX25R_EMU_ERASE_SUSPEND | MX25R_EMU_PROG_SUSPEND);
+            break;
+
+        default: break;
+
+    }
+
+}
+
+/**
+ * @brief Works out the next byte the part shifts out for the current read type command
+ *
+ * @return uint8_t: The byte on the bus
+ */
+static uint8_t MX25REmulatorNextByte(void) {
+
+    const uint32_t index = emu.data_count++;
+
+    switch(emu.header[0]) {
+
+        case MX25R_READ:
+        case MX25R_FAST_READ: {
+
+            const uint8_t needed = emu.header[0] == MX25R_READ ? 4 : 5;
+            if(emu.header_size < needed)
+                return 0xff;
+
+            if(emu.is_in_otp)
+                return emu.otp[(MX25REmulatorAddress() + index) % MX25R_EMU_OTP_SIZE];
+
+            return emu.memory[(MX25REmulatorAddress() + index) & (emu.capacity - 1)];
+
+        }
+
+        case MX25R_READ_STAT_REG: return emu.status;
+        case MX25R_READ_CONFIG_REG: return emu.config[index & 1];
+        case MX25R_READ_SEC_REG: return emu.security;
+
+        case MX25R_READ_ID: {
+
+            // the density code is log2 of the capacity
+            uint8_t density = 0;
+            while((1ul << density) < emu.capacity)
+                density++;
+
+            const uint8_t id[] = { 0xc2, 0x28, density };
+            return index < 3 ? id[index] : 0xff;
+
+        }
+
+        case MX25R_READ_ESIG:
+        case MX25R_READ_EMID: {
+
+            uint8_t density = 0;
+            while((1ul << density) < emu.capacity)
+                density++;
+
+            if(emu.header[0] == MX25R_READ_ESIG)
+                return density;
+
+            return (index & 1) ? density : 0xc2;
+
+        }
+
+        default: return 0xff;
+
+    }
+
+}
+
+/**
+ * @brief Emulated chip select, a pulse while asleep wakes the part up
+ *
+ * @param[in] is_selected: If CS is pulled low
+ */
+static void MX25REmulatorSelect(const bool is_selected) {
+
+    MX25REmulatorAdvance(0);
+
+    if(is_selected) {
+
+        emu.transaction_count++;
+        emu.header_size = 0;
+        emu.data_count = 0;
+        memset(emu.page_written, 0, sizeof(emu.page_written));
+
+        emu.is_ignored = emu.is_sleeping || emu.now_ns < emu.awake_at_ns;
+
+        if(emu.is_sleeping) {
+            emu.is_sleeping = false;
+            emu.awake_at_ns = emu.now_ns + emu.timing.wake_ns;
+        }
+
+        return;
+
+    }
+
+    if(emu.is_ignored || emu.header_size == 0)
+        return;
+
+    // while busy the part only listens to status reads, suspend and reset
+    const uint8_t command = emu.header[0];
+    if(emu.operation != MX25R_EMU_IDLE && command != MX25R_SUSPEND && command != MX25R_RESET_EN && command != MX25R_RESET)
+        return;
+
+    MX25REmulatorExecute();
+
+}
+
+/**
+ * @brief Emulated SPI write, clocks in the command header and then any page program data
+ *
+ * @param[in] data: Bytes to clock in
+ * @param[in] size: How many bytes
+ * @return uint32_t: How many bytes were written
+ */
+static uint32_t MX25REmulatorWrite(const void* const data, const uint32_t size) {
+
+    const uint8_t* const bytes = (const uint8_t*)data;
+
+    MX25REmulatorAdvance(size);
+
+    for(uint32_t i = 0; i < size; i++) {
+
+        if(emu.header_size < MX25R_EMU_HEADER_SIZE && (emu.header_size < 4 || emu.header[0] != MX25R_PAGE_PROG)) {
+
+            emu.header[emu.header_size++] = bytes[i];
+
+            // a command clocked faster than it allows is not seen by the part at all
+            if(emu.header_size == 1 && emu.timing.spi_hz > (bytes[i] == MX25R_READ ? emu.timing.read_max_hz : emu.timing.max_hz))
+                emu.is_ignored = true;
+
+            continue;
+
+        }
+
+        if(emu.header[0] != MX25R_PAGE_PROG)
+            continue;
+
+        const uint8_t offset = (uint8_t)(emu.header[3] + emu.data_count++);
+        emu.page[offset] = bytes[i];
+        emu.page_written[offset] = true;
+
+    }
+
+    return size;
+
+}
+
+/**
+ * @brief Emulated SPI read, shifts out whatever the current command produces
+ *
+ * @param[out] data: Where to put the bytes
+ * @param[in] size: How many bytes to read
+ * @return uint32_t: How many bytes were read
+ */
+static uint32_t MX25REmulatorRead(void* const data, const uint32_t size) {
+
+    uint8_t* const bytes = (uint8_t*)data;
+
+    MX25REmulatorAdvance(size);
+    emu.read_bytes += size;
+
+    const bool is_status_read = emu.header[0] == MX25R_READ_STAT_REG || emu.header[0] == MX25R_READ_SEC_REG || emu.header[0] == MX25R_READ_CONFIG_REG;
+
+    for(uint32_t i = 0; i < size; i++) {
+
+        if(emu.is_ignored || emu.header_size == 0 || (emu.operation != MX25R_EMU_IDLE && !is_status_read))
+            bytes[i] = 0xff;
+        else
+            bytes[i] = MX25REmulatorNextByte();
+
+    }
+
+    return size;
+
+}
+
+uint8_t MX25REmulatorInit(const uint32_t capacity, const char* const path) {
+
+    // the driver's page and block types top out at the 64Mbit part
+    if(capacity < (1ul << 20) || capacity > (1ul << 23) || (capacity & (capacity - 1)) != 0)
+        return 0;
+
+    free(emu.memory);
+    memset(&emu, 0, sizeof(emu));
+
+    emu.memory = (uint8_t*)malloc(capacity);
+    if(emu.memory == NULL)
+        return 0;
+
+    emu.capacity = capacity;
+    memset(emu.memory, 0xff, capacity);
+    memset(emu.otp, 0xff, sizeof(emu.otp));
+
+    emu.timing = (MX25REmulatorTiming){
+        .spi_hz = 8000000,
+        .read_max_hz = 33000000,
+        .max_hz = 80000000,
+        .page_program_ns = 850000,
+        .sector_erase_ns = 40000000,
+        .block_erase32_ns = 200000000,
+        .block_erase_ns = 400000000,
+        .chip_erase_ms = 50000,
+        .suspend_ns = 20000,
+        .wake_ns = 35000
+    };
+
+    if(path == NULL)
+        return 1;
+
+    FILE* const file = fopen(path, "rb");
+    if(file == NULL)
+        return 1;
+
+    // a short file just leaves the rest of the part blank
+    fread(emu.memory, 1, capacity, file);
+    fclose(file);
+
+    return 1;
+
+}
+
+uint8_t MX25REmulatorSave(const char* const path) {
+
+    FILE* const file = fopen(path, "wb");
+    if(file == NULL)
+        return 0;
+
+    const size_t written = fwrite(emu.memory, 1, emu.capacity, file);
+    fclose(file);
+
+    return written == emu.capacity;
+
+}
+
+void MX25REmulatorDeinit(void) {
+
+    free(emu.memory);
+    memset(&emu, 0, sizeof(emu));
+
+}
+
+const MX25RHAL* MX25REmulatorGetHAL(void) {
+
+    static const MX25RHAL hal = { MX25REmulatorWrite, MX25REmulatorRead, MX25REmulatorSelect };
+    return &hal;
+
+}
+
+uint8_t* MX25REmulatorGetMemory(void) { return emu.memory; }
+
+void MX25REmulatorSchedulePowerCut(const uint32_t operations, const uint8_t percent_done, void (*cut)(void)) {
+
+    emu.cut_at = emu.operation_count + operations;
+    emu.cut_percent = percent_done > 100 ? 100 : percent_done;
+    emu.cut = cut;
+
+}
+
+void MX25REmulatorCancelPowerCut(void) { emu.cut = NULL; }
+
+uint32_t MX25REmulatorGetOperationCount(void) { return emu.operation_count; }
+
+uint32_t MX25REmulatorGetTransactionCount(void) { return emu.transaction_count; }
+
+uint64_t MX25REmulatorGetReadByteCount(void) { return emu.read_bytes; }
+
+MX25REmulatorTiming* MX25REmulatorGetTiming(void) { return &emu.timing; }
+
+uint64_t MX25REmulatorGetTimeNs(void) { return emu.now_ns; }
+
+void MX25REmulatorWait(const uint64_t ns) {
+
+    emu.now_ns += ns;
+    MX25REmulatorAdvance(0);
+
+}
+
+bool MX25REmulatorIsAsleep(void) { return emu.is_sleeping; }
+
+void MX25REmulatorPeekRegisters(uint8_t* const status, uint8_t* const config, uint8_t* const security) {
+
+    MX25REmulatorAdvance(0);
+
+    *status = emu.status;
+    config[0] = emu.config[0];
+    config[1] = emu.config[1];
+    *security = emu.security;
+
+}
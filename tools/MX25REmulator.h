@@ -0,0 +1,146 @@
+/**
+ * @file MX25REmulator.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Definitions and Declarations for a Host Side Emulated MX25R that plugs in as the HAL
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_EMULATOR_H
+#define MX25R_EMULATOR_H
+
+#include "MX25R.h"
+
+/// @brief How long the emulated part takes to do things, in nanoseconds of emulated time, defaults are the typical datasheet values
+typedef struct MX25REMULATORTIMING {
+
+    uint32_t spi_hz;            ///< SPI clock the bus is modeled at
+    uint32_t read_max_hz;       ///< Fastest clock a plain read (fR) works at, the part ignores one clocked faster
+    uint32_t max_hz;            ///< Fastest clock every other command (fC) works at in high performance mode, the part ignores one clocked faster
+    uint32_t page_program_ns;   ///< How long a page program keeps WIP set
+    uint32_t sector_erase_ns;   ///< How long a 4KB sector erase keeps WIP set
+    uint32_t block_erase32_ns;  ///< How long a 32KB block erase keeps WIP set
+    uint32_t block_erase_ns;    ///< How long a 64KB block erase keeps WIP set
+    uint32_t chip_erase_ms;     ///< How long a chip erase keeps WIP set, in milliseconds since it does not fit in nanoseconds
+    uint32_t suspend_ns;        ///< How long a suspend takes to land
+    uint32_t wake_ns;           ///< How long it takes to come out of deep sleep after a CS pulse
+
+} MX25REmulatorTiming;
+
+/**
+ * @brief Creates an emulated part, either blank or loaded from a file holding a raw image of the flash
+ *
+ * @param[in] capacity: How many bytes the part holds, a power of two between 1MB and 8MB
+ * @param[in] path: File to load the contents from, NULL or a file that does not exist to start blank
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25REmulatorInit(const uint32_t capacity, const char* const path);
+
+/**
+ * @brief Writes the contents of the emulated part out to a file
+ *
+ * @param[in] path: File to write to
+ * @return uint8_t: Status, 0 if there was an error
+ */
+uint8_t MX25REmulatorSave(const char* const path);
+
+/**
+ * @brief Frees the emulated part
+ */
+void MX25REmulatorDeinit(void);
+
+/**
+ * @brief Gets the HAL that talks to the emulated part, pass this to MX25RInit
+ *
+ * @return const MX25RHAL*: The emulator's HAL
+ */
+const MX25RHAL* MX25REmulatorGetHAL(void);
+
+/**
+ * @brief Gets direct access to the emulated flash array, for checking results without going through the bus
+ *
+ * @return uint8_t*: The flash contents, capacity bytes long
+ */
+uint8_t* MX25REmulatorGetMemory(void);
+
+/**
+ * @brief Schedules a power cut on a later program or erase, for testing what survives a power loss
+ * @note The cut operation only partly lands, then the part comes back up in its power on state and cut is called,
+ *       which is expected to unwind back to the test, with longjmp for example, since the driver call it happened in is lost too
+ *
+ * @param[in] operations: How many programs and erases run in full before the one that is cut, 0 cuts the next one
+ * @param[in] percent_done: How much of the cut operation lands, counted from the start of the page or erase range
+ * @param[in] cut: Called once the power is gone
+ */
+void MX25REmulatorSchedulePowerCut(const uint32_t operations, const uint8_t percent_done, void (*cut)(void));
+
+/**
+ * @brief Cancels a scheduled power cut that has not happened yet
+ */
+void MX25REmulatorCancelPowerCut(void);
+
+/**
+ * @brief Gets how many programs and erases the part has started, to find out how many cut points a piece of work has
+ *
+ * @return uint32_t: Programs and erases since init
+ */
+uint32_t MX25REmulatorGetOperationCount(void);
+
+/**
+ * @brief Gets how many transactions went over the bus, to check what a driver call costs
+ *
+ * @return uint32_t: How many times CS was pulled low since init
+ */
+uint32_t MX25REmulatorGetTransactionCount(void);
+
+/**
+ * @brief Gets how many bytes were read off the bus, to check how much of the part a piece of work reads
+ *
+ * @return uint64_t: Bytes clocked out of the part since init, status reads included
+ */
+uint64_t MX25REmulatorGetReadByteCount(void);
+
+/**
+ * @brief Gets the timing model, changes take effect on the next command
+ *
+ * @return MX25REmulatorTiming*: The timing used by the emulated part
+ */
+MX25REmulatorTiming* MX25REmulatorGetTiming(void);
+
+/**
+ * @brief Gets how much emulated time has passed, the bus and every busy wait on WIP move it forward
+ *
+ * @return uint64_t: Emulated time since init in nanoseconds
+ */
+uint64_t MX25REmulatorGetTimeNs(void);
+
+/**
+ * @brief Lets emulated time pass with nothing on the bus, as a delay on the host would
+ *
+ * @param[in] ns: How long to wait in nanoseconds
+ */
+void MX25REmulatorWait(const uint64_t ns);
+
+/**
+ * @brief Checks if the part is in deep sleep, without the CS pulse that would wake it
+ *
+ * @return true: If the part is in deep sleep
+ * @return false: If it is awake or waking up
+ */
+bool MX25REmulatorIsAsleep(void);
+
+/**
+ * @brief Gets the registers as the part holds them right now, without going through the bus or the driver's shadow
+ *
+ * @param[out] status: Status register
+ * @param[out] config: Both bytes of the configuration register
+ * @param[out] security: Security register
+ */
+void MX25REmulatorPeekRegisters(uint8_t* const status, uint8_t* const config, uint8_t* const security);
+
+#endif // include guard
@@ -0,0 +1,907 @@
+/**
+ * @file MX25RImage.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Host side tool that packs raw flash dumps into sparse images and programs, dumps and diffs parts with them
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * A sparse image only holds the pages that are not blank, grouped into runs of consecutive pages, all little endian:
+ *
+ *      header:  "MX25RSPI" | u32 version | u32 capacity | u32 page size | u32 run count
+ *      run:     u32 first page | u32 page count | u32 CRC32 of the run's data | page count * page size bytes of data
+ *
+ * Programming erases only the erase units the runs land in, picking the cheapest mix of 64KB, 32KB and 4KB erases,
+ * skips blank pages and the trailing 0xff of every page, and reads each run back to check its CRC.
+ */
+
+#include "MX25R.h"
+#include "MX25RToolHAL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MX25R_IMAGE_MAGIC           "MX25RSPI"  ///< First bytes of every sparse image
+#define MX25R_IMAGE_MAGIC_SIZE      8           ///< How long the magic is
+#define MX25R_IMAGE_VERSION         1           ///< Format version this tool writes
+#define MX25R_IMAGE_HEADER_SIZE     24          ///< Magic, version, capacity, page size and run count
+#define MX25R_IMAGE_RUN_SIZE        12          ///< First page, page count and CRC of a run
+
+#define MX25R_IMAGE_CHUNK_SIZE      MX25R_BLOCK_SIZE    ///< How much gets read from the part per command when dumping and diffing
+
+#ifdef MX25R_CAPACITY
+#define MX25R_IMAGE_MAX_CAPACITY    ((uint32_t)MX25R_CAPACITY)  ///< Largest part an image can be for, the one the driver is built for
+#else
+#define MX25R_IMAGE_MAX_CAPACITY    ((uint32_t)1 << 23)         ///< Largest part an image can be for, the MX25R6435F
+#endif
+
+#define MX25R_TYP_SECTOR_ERASE_MS   40      ///< Typical 4KB sector erase time from the datasheet
+#define MX25R_TYP_BLOCK_ERASE32_MS  200     ///< Typical 32KB block erase time from the datasheet
+#define MX25R_TYP_BLOCK_ERASE_MS    400     ///< Typical 64KB block erase time from the datasheet
+
+#define MX25R_SECTORS_PER_SMALL_BLOCK   (MX25R_SMALL_BLOCK_SIZE / MX25R_SECTOR_SIZE)
+#define MX25R_PAGES_PER_SECTOR          (MX25R_SECTOR_SIZE / MX25R_PAGE_SIZE)
+
+/// @brief One run of consecutive non blank pages in a sparse image
+typedef struct MX25RIMAGERUN {
+
+    uint32_t first_page;    ///< First page the run covers
+    uint32_t page_count;    ///< How many pages the run covers
+    uint32_t crc;           ///< CRC32 of the run's data
+    const uint8_t* data;    ///< The run's data, inside the loaded file
+
+} MX25RImageRun;
+
+/// @brief A loaded sparse image
+typedef struct MX25RIMAGE {
+
+    uint8_t* file;          ///< The whole image file
+    uint32_t capacity;      ///< How many bytes the part the image is for holds
+    uint32_t run_count;     ///< How many runs there are
+    MX25RImageRun* runs;    ///< The runs, in order of address
+
+} MX25RImage;
+
+/// @brief Counts of what a program or erase did
+typedef struct MX25RIMAGESTATS {
+
+    uint32_t sectors_erased;        ///< 4KB erases issued
+    uint32_t small_blocks_erased;   ///< 32KB erases issued
+    uint32_t blocks_erased;         ///< 64KB erases issued
+    uint32_t pages_programmed;      ///< Page programs issued
+    uint64_t bytes_programmed;      ///< Bytes sent in page programs
+
+} MX25RImageStats;
+
+/**
+ * @brief Runs the standard CRC32 (IEEE 802.3) over a buffer
+ *
+ * @param[in] data: Data to run over
+ * @param[in] size: How many bytes
+ * @return uint32_t: The CRC
+ */
+static uint32_t MX25RImageCrc32(const uint8_t* const data, const size_t size) {
+
+    static uint32_t table[256];
+    static bool is_table_ready = false;
+
+    if(!is_table_ready) {
+
+        for(uint32_t i = 0; i < 256; i++) {
+
+            uint32_t value = i;
+            for(uint8_t bit = 0; bit < 8; bit++)
+                value = (value >> 1) ^ (0xedb88320u & (0u - (value & 1)));
+
+            table[i] = value;
+
+        }
+
+        is_table_ready = true;
+
+    }
+
+    uint32_t crc = 0xffffffffu;
+    for(size_t i = 0; i < size; i++)
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xff];
+
+    return ~crc;
+
+}
+
+/**
+ * @brief Writes a little endian 32 bit word
+ *
+ * @param[out] out: Where to write it
+ * @param[in] value: The word
+ */
+static void MX25RImagePut32(uint8_t* const out, const uint32_t value) {
+
+    for(uint8_t i = 0; i < 4; i++)
+        out[i] = (uint8_t)(value >> (8 * i));
+
+}
+
+/**
+ * @brief Reads a little endian 32 bit word
+ *
+ * @param[in] in: Where to read it from
+ * @return uint32_t: The word
+ */
+static uint32_t MX25RImageGet32(const uint8_t* const in) { return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24); }
+
+/**
+ * @brief Checks if a buffer is all erased bytes
+ *
+ * @param[in] data: Data to check
+ * @param[in] size: How many bytes
+ * @return true: If every byte is 0xff
+ * @return false: If anything would need programming
+ */
+static bool MX25RImageIsBlank(const uint8_t* const data, const size_t size) {
+
+    for(size_t i = 0; i < size; i++)
+        if(data[i] != 0xff)
+            return false;
+
+    return true;
+
+}
+
+/**
+ * @brief Reads a whole file into memory
+ *
+ * @param[in] path: File to read
+ * @param[out] size: How many bytes were read
+ * @return uint8_t*: The contents, NULL if it could not be read, free it when done
+ */
+static uint8_t* MX25RImageReadFile(const char* const path, size_t* const size) {
+
+    FILE* const file = fopen(path, "rb");
+    if(file == NULL) {
+        fprintf(stderr, "can't open %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t* const data = length > 0 ? (uint8_t*)malloc((size_t)length) : NULL;
+    if(data == NULL || fread(data, 1, (size_t)length, file) != (size_t)length) {
+
+        fprintf(stderr, "can't read %s\n", path);
+        free(data);
+        fclose(file);
+        return NULL;
+
+    }
+
+    fclose(file);
+    *size = (size_t)length;
+
+    return data;
+
+}
+
+/**
+ * @brief Checks a part size is one an image can be for, every erase and bounds check relies on it
+ *
+ * @param[in] capacity: Size of the part in bytes
+ * @return true: If it is a whole number of blocks and no bigger than the largest part
+ * @return false: If it is not
+ */
+static bool MX25RImageIsCapacityValid(const uint64_t capacity) { return capacity != 0 && capacity % MX25R_BLOCK_SIZE == 0 && capacity <= MX25R_IMAGE_MAX_CAPACITY; }
+
+/**
+ * @brief Loads and validates a sparse image
+ *
+ * @param[out] image: Where to load it
+ * @param[in] path: File to load
+ * @return uint8_t: Status, 0 if the file is not a valid sparse image
+ */
+static uint8_t MX25RImageLoad(MX25RImage* const image, const char* const path) {
+
+    size_t size = 0;
+    image->file = MX25RImageReadFile(path, &size);
+    image->runs = NULL;
+
+    if(image->file == NULL)
+        return 0;
+
+    const uint8_t* const header = image->file;
+    if(size < MX25R_IMAGE_HEADER_SIZE || memcmp(header, MX25R_IMAGE_MAGIC, MX25R_IMAGE_MAGIC_SIZE) != 0 ||
+       MX25RImageGet32(header + 8) != MX25R_IMAGE_VERSION || MX25RImageGet32(header + 16) != MX25R_PAGE_SIZE) {
+
+        fprintf(stderr, "%s is not a sparse image\n", path);
+        return 0;
+
+    }
+
+    image->capacity = MX25RImageGet32(header + 12);
+    image->run_count = MX25RImageGet32(header + 20);
+
+    if(!MX25RImageIsCapacityValid(image->capacity)) {
+        fprintf(stderr, "%s is for a %u byte part, which is not a whole number of blocks up to %u bytes\n", path, image->capacity, MX25R_IMAGE_MAX_CAPACITY);
+        return 0;
+    }
+    image->runs = (MX25RImageRun*)calloc(image->run_count ? image->run_count : 1, sizeof(MX25RImageRun));
+
+    if(image->runs == NULL)
+        return 0;
+
+    size_t offset = MX25R_IMAGE_HEADER_SIZE;
+    for(uint32_t i = 0; i < image->run_count; i++) {
+
+        MX25RImageRun* const run = image->runs + i;
+
+        if(size - offset < MX25R_IMAGE_RUN_SIZE) {
+            fprintf(stderr, "%s is cut off in run %u\n", path, i);
+            return 0;
+        }
+
+        run->first_page = MX25RImageGet32(image->file + offset);
+        run->page_count = MX25RImageGet32(image->file + offset + 4);
+        run->crc = MX25RImageGet32(image->file + offset + 8);
+        run->data = image->file + offset + MX25R_IMAGE_RUN_SIZE;
+        offset += MX25R_IMAGE_RUN_SIZE;
+
+        const uint64_t run_size = (uint64_t)run->page_count * MX25R_PAGE_SIZE;
+        const uint64_t run_end = ((uint64_t)run->first_page + run->page_count) * MX25R_PAGE_SIZE;
+
+        // an empty run would pass the CRC check and then underflow the last page when erasing
+        if(run->page_count == 0 || run_size > size - offset || run_end > image->capacity || MX25RImageCrc32(run->data, (size_t)run_size) != run->crc) {
+            fprintf(stderr, "%s has a corrupt run %u\n", path, i);
+            return 0;
+        }
+
+        offset += (size_t)run_size;
+
+    }
+
+    return 1;
+
+}
+
+/**
+ * @brief Frees a loaded sparse image
+ *
+ * @param[in] image: Image to free
+ */
+static void MX25RImageFree(MX25RImage* const image) {
+
+    free(image->runs);
+    free(image->file);
+
+}
+
+/**
+ * @brief Opens the part and works out how big it is from its ID
+ *
+ * @param[out] dev: Device to initialize
+ * @param[in] target: What to connect to
+ * @param[in] capacity: Size hint for the HAL
+ * @return uint32_t: How many bytes the part holds, 0 if it could not be opened or is not an MX25R
+ */
+static uint32_t MX25RImageOpen(MX25R* const dev, const char* const target, const uint32_t capacity) {
+
+    const MX25RHAL* const hal = MX25RToolHALOpen(target, capacity);
+
+    #if defined(DEBUG) && !defined(MX25R_CAPACITY)
+    // the size isn't known until the ID is read, so the bounds checks start at the largest part
+    MX25R* const opened = hal == NULL ? NULL : MX25RInit(dev, hal, false, 8);
+    #else
+    MX25R* const opened = hal == NULL ? NULL : MX25RInit(dev, hal, false);
+    #endif
+
+    if(opened == NULL) {
+        fprintf(stderr, "can't open %s\n", target);
+        return 0;
+    }
+
+    // 8Mbit to 64Mbit, the address types can't reach past that
+    MX25RID id;
+    if(MX25RReadID(dev, &id) == 0 || id.id.man_id != 0xc2 || id.id.mem_density < 0x14 || id.id.mem_density > 0x17) {
+        fprintf(stderr, "no MX25R answering on %s\n", target);
+        MX25RToolHALClose();
+        return 0;
+    }
+
+    #if defined(DEBUG) && !defined(MX25R_CAPACITY)
+    dev->size_in_mb = (uint8_t)(1u << (id.id.mem_density - 20));
+    #endif
+
+    return 1ul << id.id.mem_density;
+
+}
+
+/**
+ * @brief Waits for the running program or erase to finish
+ *
+ * @param[in] dev: Device to wait on
+ */
+static void MX25RImageWait(MX25R* const dev) { while(MX25RIsWriteInProgress(dev)); }
+
+/**
+ * @brief Prints how long something took and how fast it went
+ *
+ * @param[in] what: What was done
+ * @param[in] bytes: How many bytes it moved
+ * @param[in] elapsed_ns: How long it took
+ */
+static void MX25RImageReport(const char* const what, const uint64_t bytes, const uint64_t elapsed_ns) {
+
+    const double seconds = (double)elapsed_ns / 1e9;
+    printf("%s %llu bytes in %.3f s", what, (unsigned long long)bytes, seconds);
+
+    if(elapsed_ns != 0)
+        printf(", %.1f KB/s", (double)bytes / 1024.0 / seconds);
+
+    printf("\n");
+
+}
+
+/**
+ * @brief Erases a sector range of a single 32KB half block the cheapest way, one 32KB erase or the needed sectors one at a time
+ *
+ * @param[in] dev: Device to erase
+ * @param[in] needed: Which sectors of the part need erasing
+ * @param[in] first_sector: First sector of the half block
+ * @param[out] stats: What was done
+ * @return uint8_t: Status, 0 if an erase failed
+ */
+static uint8_t MX25RImageEraseHalf(MX25R* const dev, const bool* const needed, const uint32_t first_sector, MX25RImageStats* const stats) {
+
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < MX25R_SECTORS_PER_SMALL_BLOCK; i++)
+        count += needed[first_sector + i];
+
+    if(count == 0)
+        return 1;
+
+    if(count * MX25R_TYP_SECTOR_ERASE_MS >= MX25R_TYP_BLOCK_ERASE32_MS) {
+
+        MX25REnableWriting(dev);
+        MX25REraseBlock32K(dev, (MX25RSmallBlock)(first_sector / MX25R_SECTORS_PER_SMALL_BLOCK));
+        MX25RImageWait(dev);
+        stats->small_blocks_erased++;
+
+        return MX25RVerifyErase(dev);
+
+    }
+
+    for(uint32_t i = 0; i < MX25R_SECTORS_PER_SMALL_BLOCK; i++) {
+
+        if(!needed[first_sector + i])
+            continue;
+
+        MX25REnableWriting(dev);
+        MX25REraseSector(dev, (MX25RSector)(first_sector + i));
+        MX25RImageWait(dev);
+        stats->sectors_erased++;
+
+        if(!MX25RVerifyErase(dev))
+            return 0;
+
+    }
+
+    return 1;
+
+}
+
+/**
+ * @brief Erases every erase unit that a run of the image lands in, using the biggest erase that is cheaper than the smaller ones
+ * @note Everything outside the runs is meant to be blank, so erasing more than the runs cover is always safe
+ * @param[in] dev: Device to erase
+ * @param[in] image: Image that is going to be programmed
+ * @param[out] stats: What was done
+ * @return uint8_t: Status, 0 if an erase failed
+ */
+static uint8_t MX25RImageErase(MX25R* const dev, const MX25RImage* const image, MX25RImageStats* const stats) {
+
+    const uint32_t sector_count = image->capacity / MX25R_SECTOR_SIZE;
+    bool* const needed = (bool*)calloc(sector_count, sizeof(bool));
+    if(needed == NULL)
+        return 0;
+
+    for(uint32_t i = 0; i < image->run_count; i++) {
+
+        const MX25RImageRun* const run = image->runs + i;
+        const uint32_t last_page = run->first_page + run->page_count - 1;
+
+        for(uint32_t sector = run->first_page / MX25R_PAGES_PER_SECTOR; sector <= last_page / MX25R_PAGES_PER_SECTOR; sector++)
+            needed[sector] = true;
+
+    }
+
+    uint8_t ret = 1;
+    const uint32_t sectors_per_block = MX25R_BLOCK_SIZE / MX25R_SECTOR_SIZE;
+
+    for(uint32_t block = 0; ret && block < image->capacity / MX25R_BLOCK_SIZE; block++) {
+
+        const uint32_t first_sector = block * sectors_per_block;
+        uint32_t half_cost[2] = { 0, 0 };
+
+        for(uint32_t i = 0; i < sectors_per_block; i++)
+            half_cost[i / MX25R_SECTORS_PER_SMALL_BLOCK] += needed[first_sector + i] * MX25R_TYP_SECTOR_ERASE_MS;
+
+        if(half_cost[0] == 0 && half_cost[1] == 0)
+            continue;
+
+        for(uint8_t half = 0; half < 2; half++)
+            if(half_cost[half] > MX25R_TYP_BLOCK_ERASE32_MS)
+                half_cost[half] = MX25R_TYP_BLOCK_ERASE32_MS;
+
+        if(half_cost[0] + half_cost[1] >= MX25R_TYP_BLOCK_ERASE_MS) {
+
+            MX25REnableWriting(dev);
+            MX25REraseBlock(dev, (MX25RBlock)block);
+            MX25RImageWait(dev);
+            stats->blocks_erased++;
+            ret = MX25RVerifyErase(dev);
+            continue;
+
+        }
+
+        ret = MX25RImageEraseHalf(dev, needed, first_sector, stats) && MX25RImageEraseHalf(dev, needed, first_sector + MX25R_SECTORS_PER_SMALL_BLOCK, stats);
+
+    }
+
+    free(needed);
+
+    return ret;
+
+}
+
+/**
+ * @brief Programs one run, leaving out blank pages and the trailing 0xff of each page, then reads it back and checks its CRC
+ *
+ * @param[in] dev: Device to program
+ * @param[in] run: Run to program
+ * @param[out] stats: What was done
+ * @return uint8_t: Status, 0 if programming or the verify failed
+ */
+static uint8_t MX25RImageProgramRun(MX25R* const dev, const MX25RImageRun* const run, MX25RImageStats* const stats) {
+
+    for(uint32_t i = 0; i < run->page_count; i++) {
+
+        const uint8_t* const page = run->data + (size_t)i * MX25R_PAGE_SIZE;
+
+        uint16_t size = MX25R_PAGE_SIZE;
+        while(size > 0 && page[size - 1] == 0xff)
+            size--;
+
+        if(size == 0)
+            continue;
+
+        MX25REnableWriting(dev);
+        MX25RPageProgram(dev, (MX25RPage)(run->first_page + i), page, size);
+        MX25RImageWait(dev);
+
+        stats->pages_programmed++;
+        stats->bytes_programmed += size;
+
+        if(!MX25RVerifyProgram(dev))
+            return 0;
+
+    }
+
+    const size_t run_size = (size_t)run->page_count * MX25R_PAGE_SIZE;
+    uint8_t* const readback = (uint8_t*)malloc(run_size);
+    if(readback == NULL)
+        return 0;
+
+    MX25RFastRead(dev, run->first_page * MX25R_PAGE_SIZE, readback, (uint32_t)run_size);
+    const uint8_t ret = MX25RImageCrc32(readback, run_size) == run->crc;
+
+    free(readback);
+
+    return ret;
+
+}
+
+/**
+ * @brief Packs a raw dump into a sparse image
+ *
+ * @param[in] raw_path: Raw dump to pack
+ * @param[in] sparse_path: Where to write the sparse image
+ * @return int: Exit code
+ */
+static int MX25RImagePack(const char* const raw_path, const char* const sparse_path) {
+
+    size_t size = 0;
+    uint8_t* const raw = MX25RImageReadFile(raw_path, &size);
+    if(raw == NULL)
+        return 1;
+
+    if(!MX25RImageIsCapacityValid(size)) {
+        fprintf(stderr, "%s is not a whole number of blocks up to %u bytes\n", raw_path, MX25R_IMAGE_MAX_CAPACITY);
+        free(raw);
+        return 1;
+    }
+
+    FILE* const out = fopen(sparse_path, "wb");
+    if(out == NULL) {
+        fprintf(stderr, "can't create %s\n", sparse_path);
+        free(raw);
+        return 1;
+    }
+
+    uint8_t header[MX25R_IMAGE_HEADER_SIZE];
+    memcpy(header, MX25R_IMAGE_MAGIC, MX25R_IMAGE_MAGIC_SIZE);
+    MX25RImagePut32(header + 8, MX25R_IMAGE_VERSION);
+    MX25RImagePut32(header + 12, (uint32_t)size);
+    MX25RImagePut32(header + 16, MX25R_PAGE_SIZE);
+    MX25RImagePut32(header + 20, 0);
+    fwrite(header, 1, sizeof(header), out);
+
+    const uint32_t page_count = (uint32_t)(size / MX25R_PAGE_SIZE);
+    uint32_t run_count = 0, data_pages = 0;
+
+    for(uint32_t page = 0; page < page_count;) {
+
+        if(MX25RImageIsBlank(raw + (size_t)page * MX25R_PAGE_SIZE, MX25R_PAGE_SIZE)) {
+            page++;
+            continue;
+        }
+
+        uint32_t end = page + 1;
+        while(end < page_count && !MX25RImageIsBlank(raw + (size_t)end * MX25R_PAGE_SIZE, MX25R_PAGE_SIZE))
+            end++;
+
+        const uint8_t* const data = raw + (size_t)page * MX25R_PAGE_SIZE;
+        const size_t run_size = (size_t)(end - page) * MX25R_PAGE_SIZE;
+
+        uint8_t run[MX25R_IMAGE_RUN_SIZE];
+        MX25RImagePut32(run, page);
+        MX25RImagePut32(run + 4, end - page);
+        MX25RImagePut32(run + 8, MX25RImageCrc32(data, run_size));
+        fwrite(run, 1, sizeof(run), out);
+        fwrite(data, 1, run_size, out);
+
+        run_count++;
+        data_pages += end - page;
+        page = end;
+
+    }
+
+    MX25RImagePut32(header + 20, run_count);
+    fseek(out, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), out);
+
+    const int failed = ferror(out);
+    fclose(out);
+    free(raw);
+
+    if(failed) {
+        fprintf(stderr, "failed writing %s\n", sparse_path);
+        return 1;
+    }
+
+    printf("%u of %u pages hold data, %u runs\n", data_pages, page_count, run_count);
+
+    return 0;
+
+}
+
+/**
+ * @brief Prints what is in a sparse image
+ *
+ * @param[in] sparse_path: Image to describe
+ * @return int: Exit code
+ */
+static int MX25RImageInfo(const char* const sparse_path) {
+
+    MX25RImage image;
+    if(MX25RImageLoad(&image, sparse_path) == 0) {
+        MX25RImageFree(&image);
+        return 1;
+    }
+
+    uint32_t data_pages = 0;
+    for(uint32_t i = 0; i < image.run_count; i++) {
+
+        printf("run %u: pages %u-%u, crc %08x\n", i, image.runs[i].first_page, image.runs[i].first_page + image.runs[i].page_count - 1, image.runs[i].crc);
+        data_pages += image.runs[i].page_count;
+
+    }
+
+    printf("%u bytes part, %u of %u pages hold data, %u runs\n", image.capacity, data_pages, image.capacity / MX25R_PAGE_SIZE, image.run_count);
+
+    MX25RImageFree(&image);
+
+    return 0;
+
+}
+
+/**
+ * @brief Erases what is needed and programs a sparse image, verifying every run
+ *
+ * @param[in] target: Part to program
+ * @param[in] capacity: Size hint for the HAL
+ * @param[in] sparse_path: Image to program
+ * @return int: Exit code
+ */
+static int MX25RImageProgram(const char* const target, const uint32_t capacity, const char* const sparse_path) {
+
+    MX25RImage image;
+    if(MX25RImageLoad(&image, sparse_path) == 0) {
+        MX25RImageFree(&image);
+        return 1;
+    }
+
+    MX25R dev;
+    const uint32_t part_capacity = MX25RImageOpen(&dev, target, capacity ? capacity : image.capacity);
+    if(part_capacity == 0) {
+        MX25RImageFree(&image);
+        return 1;
+    }
+
+    if(part_capacity != image.capacity) {
+        fprintf(stderr, "image is for a %u byte part but the part holds %u bytes\n", image.capacity, part_capacity);
+        MX25RToolHALClose();
+        MX25RImageFree(&image);
+        return 1;
+    }
+
+    MX25RImageStats stats = { 0 };
+    int ret = 0;
+
+    const uint64_t start = MX25RToolHALTimeNs();
+
+    if(MX25RImageErase(&dev, &image, &stats) == 0) {
+        fprintf(stderr, "erase failed\n");
+        ret = 1;
+    }
+
+    const uint64_t erased = MX25RToolHALTimeNs();
+
+    for(uint32_t i = 0; ret == 0 && i < image.run_count; i++) {
+
+        if(MX25RImageProgramRun(&dev, image.runs + i, &stats) == 0) {
+            fprintf(stderr, "run %u at page %u failed to verify\n", i, image.runs[i].first_page);
+            ret = 1;
+        }
+
+    }
+
+    const uint64_t end = MX25RToolHALTimeNs();
+
+    printf("erased %u x 64KB, %u x 32KB, %u x 4KB\n", stats.blocks_erased, stats.small_blocks_erased, stats.sectors_erased);
+    printf("programmed %u of %u pages\n", stats.pages_programmed, image.capacity / MX25R_PAGE_SIZE);
+    printf("erasing took %.3f s\n", (double)(erased - start) / 1e9);
+    MX25RImageReport("programmed and verified", stats.bytes_programmed, end - erased);
+    MX25RImageReport("total", stats.bytes_programmed, end - start);
+
+    MX25RToolHALClose();
+    MX25RImageFree(&image);
+
+    return ret;
+
+}
+
+/**
+ * @brief Reads the whole part out to a raw file
+ *
+ * @param[in] target: Part to read
+ * @param[in] capacity: Size hint for the HAL
+ * @param[in] raw_path: Where to write the dump
+ * @return int: Exit code
+ */
+static int MX25RImageDump(const char* const target, const uint32_t capacity, const char* const raw_path) {
+
+    MX25R dev;
+    const uint32_t part_capacity = MX25RImageOpen(&dev, target, capacity);
+    if(part_capacity == 0)
+        return 1;
+
+    FILE* const out = fopen(raw_path, "wb");
+    uint8_t* const chunk = (uint8_t*)malloc(MX25R_IMAGE_CHUNK_SIZE);
+
+    if(out == NULL || chunk == NULL) {
+
+        fprintf(stderr, "can't create %s\n", raw_path);
+        free(chunk);
+        if(out != NULL)
+            fclose(out);
+        MX25RToolHALClose();
+        return 1;
+
+    }
+
+    uint64_t elapsed = 0;
+    for(uint32_t address = 0; address < part_capacity; address += MX25R_IMAGE_CHUNK_SIZE) {
+
+        const uint64_t start = MX25RToolHALTimeNs();
+        MX25RFastRead(&dev, address, chunk, MX25R_IMAGE_CHUNK_SIZE);
+        elapsed += MX25RToolHALTimeNs() - start;
+
+        fwrite(chunk, 1, MX25R_IMAGE_CHUNK_SIZE, out);
+
+    }
+
+    const int failed = ferror(out);
+    fclose(out);
+    free(chunk);
+    MX25RToolHALClose();
+
+    if(failed) {
+        fprintf(stderr, "failed writing %s\n", raw_path);
+        return 1;
+    }
+
+    MX25RImageReport("dumped", part_capacity, elapsed);
+
+    return 0;
+
+}
+
+/**
+ * @brief Compares the part against a sparse image or raw dump and prints the page ranges that differ
+ *
+ * @param[in] target: Part to compare
+ * @param[in] capacity: Size hint for the HAL
+ * @param[in] path: Sparse image or raw dump to compare against
+ * @return int: Exit code, 1 if anything differs
+ */
+static int MX25RImageDiff(const char* const target, const uint32_t capacity, const char* const path) {
+
+    size_t size = 0;
+    uint8_t* expected = MX25RImageReadFile(path, &size);
+    if(expected == NULL)
+        return 1;
+
+    // a sparse image gets expanded out to what the whole part should read back as
+    if(size >= MX25R_IMAGE_MAGIC_SIZE && memcmp(expected, MX25R_IMAGE_MAGIC, MX25R_IMAGE_MAGIC_SIZE) == 0) {
+
+        free(expected);
+
+        MX25RImage image;
+        if(MX25RImageLoad(&image, path) == 0) {
+            MX25RImageFree(&image);
+            return 1;
+        }
+
+        size = image.capacity;
+        expected = (uint8_t*)malloc(size);
+        if(expected == NULL) {
+            MX25RImageFree(&image);
+            return 1;
+        }
+
+        memset(expected, 0xff, size);
+        for(uint32_t i = 0; i < image.run_count; i++)
+            memcpy(expected + (size_t)image.runs[i].first_page * MX25R_PAGE_SIZE, image.runs[i].data, (size_t)image.runs[i].page_count * MX25R_PAGE_SIZE);
+
+        MX25RImageFree(&image);
+
+    }
+
+    MX25R dev;
+    const uint32_t part_capacity = MX25RImageOpen(&dev, target, capacity ? capacity : (uint32_t)size);
+    if(part_capacity == 0) {
+        free(expected);
+        return 1;
+    }
+
+    if(part_capacity != size) {
+        fprintf(stderr, "%s is %zu bytes but the part holds %u bytes\n", path, size, part_capacity);
+        MX25RToolHALClose();
+        free(expected);
+        return 1;
+    }
+
+    uint8_t* const chunk = (uint8_t*)malloc(MX25R_IMAGE_CHUNK_SIZE);
+    if(chunk == NULL) {
+        MX25RToolHALClose();
+        free(expected);
+        return 1;
+    }
+
+    uint64_t elapsed = 0;
+    uint32_t differing = 0, range_start = 0;
+    bool is_in_range = false;
+
+    for(uint32_t address = 0; address < part_capacity; address += MX25R_IMAGE_CHUNK_SIZE) {
+
+        const uint64_t start = MX25RToolHALTimeNs();
+        MX25RFastRead(&dev, address, chunk, MX25R_IMAGE_CHUNK_SIZE);
+        elapsed += MX25RToolHALTimeNs() - start;
+
+        for(uint32_t offset = 0; offset < MX25R_IMAGE_CHUNK_SIZE; offset += MX25R_PAGE_SIZE) {
+
+            const uint32_t page = (address + offset) / MX25R_PAGE_SIZE;
+            const bool is_different = memcmp(chunk + offset, expected + address + offset, MX25R_PAGE_SIZE) != 0;
+
+            if(is_different && !is_in_range)
+                range_start = page;
+            else if(!is_different && is_in_range)
+                printf("pages %u-%u differ\n", range_start, page - 1);
+
+            is_in_range = is_different;
+            differing += is_different;
+
+        }
+
+    }
+
+    if(is_in_range)
+        printf("pages %u-%u differ\n", range_start, part_capacity / MX25R_PAGE_SIZE - 1);
+
+    printf("%u of %u pages differ\n", differing, part_capacity / MX25R_PAGE_SIZE);
+    MX25RImageReport("compared", part_capacity, elapsed);
+
+    free(chunk);
+    free(expected);
+    MX25RToolHALClose();
+
+    return differing != 0;
+
+}
+
+/**
+ * @brief Prints how to use the tool
+ *
+ * @param[in] name: What the tool was run as
+ * @return int: Exit code for bad usage
+ */
+static int MX25RImageUsage(const char* const name) {
+
+    fprintf(stderr,
+        "usage: %s <command> [-t target] [-s size in MB] <args>\n"
+        "  pack <raw dump> <sparse image>   pack a raw dump into a sparse image\n"
+        "  info <sparse image>              list the runs in a sparse image\n"
+        "  program <sparse image>           erase what is needed, program and verify a sparse image\n"
+        "  dump <raw dump>                  read the whole part out to a file\n"
+        "  diff <sparse image | raw dump>   list the pages that differ from the part\n"
+        "the target is handed to the HAL, for the emulator it is the image file backing the part (default flash.bin)\n",
+        name);
+
+    return 2;
+
+}
+
+int main(int argc, char** argv) {
+
+    if(argc < 2)
+        return MX25RImageUsage(argv[0]);
+
+    const char* const command = argv[1];
+    const char* target = "flash.bin";
+    uint32_t capacity = 0;
+
+    int option;
+    while((option = getopt(argc - 1, argv + 1, "t:s:")) != -1) {
+
+        switch(option) {
+            case 't': target = optarg; break;
+            case 's': capacity = (uint32_t)strtoul(optarg, NULL, 0) << 20; break;
+            default: return MX25RImageUsage(argv[0]);
+        }
+
+    }
+
+    const int arg_count = argc - 1 - optind;
+    char** const args = argv + 1 + optind;
+
+    if(strcmp(command, "pack") == 0 && arg_count == 2)
+        return MX25RImagePack(args[0], args[1]);
+
+    if(strcmp(command, "info") == 0 && arg_count == 1)
+        return MX25RImageInfo(args[0]);
+
+    if(strcmp(command, "program") == 0 && arg_count == 1)
+        return MX25RImageProgram(target, capacity, args[0]);
+
+    if(strcmp(command, "dump") == 0 && arg_count == 1)
+        return MX25RImageDump(target, capacity, args[0]);
+
+    if(strcmp(command, "diff") == 0 && arg_count == 1)
+        return MX25RImageDiff(target, capacity, args[0]);
+
+    return MX25RImageUsage(argv[0]);
+
+}
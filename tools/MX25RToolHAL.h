@@ -0,0 +1,40 @@
+/**
+ * @file MX25RToolHAL.h
+ * @author orion Serup (oserup@proton.me)
+ * @brief Contains the Declarations of the HAL hooks the host tools are built against, swap the implementation to run them on real hardware
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#pragma once
+
+#ifndef MX25R_TOOL_HAL_H
+#define MX25R_TOOL_HAL_H
+
+#include "MX25R.h"
+
+/**
+ * @brief Opens the connection to the flash the tool works on
+ *
+ * @param[in] target: What to connect to, meaning depends on the implementation, for the emulator it is the image file backing the part
+ * @param[in] capacity: How many bytes the part holds, 0 to work it out, only used if the implementation can't tell
+ * @return const MX25RHAL*: The HAL to hand to MX25RInit, NULL if it could not be opened
+ */
+const MX25RHAL* MX25RToolHALOpen(const char* const target, const uint32_t capacity);
+
+/**
+ * @brief Closes the connection opened by @ref MX25RToolHALOpen, the emulator writes its image back out here
+ */
+void MX25RToolHALClose(void);
+
+/**
+ * @brief Gets the time throughput is measured against
+ *
+ * @return uint64_t: A monotonic time in nanoseconds, the emulator reports its emulated time
+ */
+uint64_t MX25RToolHALTimeNs(void);
+
+#endif // include guard
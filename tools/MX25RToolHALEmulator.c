@@ -0,0 +1,59 @@
+/**
+ * @file MX25RToolHALEmulator.c
+ * @author Orion Serup (oserup@proton.me)
+ * @brief Contains the Implementation of the host tool HAL hooks on top of the emulated part
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MX25RToolHAL.h"
+#include "MX25REmulator.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define MX25R_TOOL_DEFAULT_CAPACITY (1ul << 21)  ///< Size of a fresh emulated part when none was given, matches the MX25R1635F
+
+static const char* image_path = NULL;   ///< The image file backing the part, written back on close
+
+const MX25RHAL* MX25RToolHALOpen(const char* const target, const uint32_t capacity) {
+
+    uint32_t size = capacity;
+
+    // an existing image decides the size of the part
+    FILE* const file = fopen(target, "rb");
+    if(file != NULL) {
+
+        if(fseek(file, 0, SEEK_END) == 0 && ftell(file) > 0)
+            size = (uint32_t)ftell(file);
+
+        fclose(file);
+
+    }
+
+    if(size == 0)
+        size = MX25R_TOOL_DEFAULT_CAPACITY;
+
+    if(MX25REmulatorInit(size, target) == 0)
+        return NULL;
+
+    image_path = target;
+
+    return MX25REmulatorGetHAL();
+
+}
+
+void MX25RToolHALClose(void) {
+
+    if(image_path != NULL && MX25REmulatorSave(image_path) == 0)
+        fprintf(stderr, "failed to write the emulated part back to %s\n", image_path);
+
+    image_path = NULL;
+    MX25REmulatorDeinit();
+
+}
+
+uint64_t MX25RToolHALTimeNs(void) { return MX25REmulatorGetTimeNs(); }